@@ -0,0 +1,924 @@
+/****************************************************************************
+rotbench : throughput and accuracy of the rotation constructions in the
+rotationmath library, written as JSON so runs can be compared by script
+
+every path starts from the same (start,dest) unit vector pairs
+  quatToMat4     rotationBetweenVectors then toMat4
+  batchToMat4    rotationBetweenVectorsBatch then toMat4
+  deriveMatrix   deriveRotMatrixToRotateV2toV1 (acos then cos / sin)
+  axisAngle      cross / acos then matrixFromAxisAngle
+  toEuler        cross / acos then toEuler (computed in double)
+  toEulerFloat   cross / acos then eulerAngles computed in float
+and every result is measured the same way against the exact input pair : the
+residual |R start - dest| of the rotation it describes (the Euler angles are
+turned back into a matrix in double) and how far R is from orthonormal, the
+largest entry of |R R^T - I|.
+The last four are also run with the LOW and MEDIUM trig tiers (deriveMatrixLow ...)
+
+the trig section times the FastTrig array functions of each tier and their
+worst absolute error against libm in double
+
+the animation section samples random keyframe tracks
+  referenceNlerp / referenceSlerp   one track at a time, scalar (slerp in double)
+  batchNlerp / batchSlerp           AnimationSet::sample on one thread
+  batchSlerpThreaded                AnimationSet::sample on a JobSystem of every hardware thread
+the batched results are compared against the reference of the same mode
+
+the jobs section runs the per-object scene update (vector pair alignment into a
+TransformStore, model matrix, MVP and normal matrix) over a JobSystem of 1 to N
+threads
+
+the cull section tests the same number of bounding spheres scattered around a
+camera against its frustum with cullSpheres and checks the visible list against
+a plane by plane scalar test
+
+each section is written as its own object under its name (rotation, animation,
+trig, jobs, cull), --section runs only the named ones and can be repeated
+****************************************************************************/
+#include "Animation.h"
+#include "FastTrig.h"
+#include "FrustumCull.h"
+#include "JobSystem.h"
+#include "RotationBatch.h"
+#include "RotationMath.h"
+#include "TransformStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+  #include <x86intrin.h>
+  #define HAS_RDTSC
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the exact input pairs and the reference animation are evaluated in double
+//----------------------------------------------------------------------------------------------------------------------
+typedef rmath::TVec3<double> DVec3;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the input sets
+//----------------------------------------------------------------------------------------------------------------------
+enum class Distribution { UNIFORM, NEAR_PARALLEL, NEAR_ANTIPARALLEL };
+
+const char *distributionName(Distribution _d)
+{
+  switch(_d)
+  {
+    case Distribution::UNIFORM : return "uniform";
+    case Distribution::NEAR_PARALLEL : return "nearParallel";
+    case Distribution::NEAR_ANTIPARALLEL : return "nearAntiparallel";
+  }
+  return "";
+}
+
+struct Inputs
+{
+  std::vector<float> m_sx,m_sy,m_sz,m_dx,m_dy,m_dz;
+  size_t size() const { return m_sx.size(); }
+  DVec3 start(size_t _i) const { return {m_sx[_i],m_sy[_i],m_sz[_i]}; }
+  DVec3 dest(size_t _i) const { return {m_dx[_i],m_dy[_i],m_dz[_i]}; }
+};
+
+Inputs makeInputs(Distribution _d, size_t _count, unsigned int _seed)
+{
+  std::mt19937 gen(_seed);
+  std::normal_distribution<double> normal;
+  // perturbations between 1e-6 and 1e-2 radians
+  std::uniform_real_distribution<double> logEps(-6.0,-2.0);
+  auto randomUnit=[&]()
+  {
+    DVec3 v;
+    do
+    {
+      v={normal(gen),normal(gen),normal(gen)};
+    } while(v.dot(v)<1e-12);
+    v.normalize();
+    return v;
+  };
+
+  Inputs in;
+  for(auto *v : {&in.m_sx,&in.m_sy,&in.m_sz,&in.m_dx,&in.m_dy,&in.m_dz})
+    v->resize(_count);
+  for(size_t i=0; i<_count; ++i)
+  {
+    DVec3 s=randomUnit();
+    DVec3 d=randomUnit();
+    if(_d!=Distribution::UNIFORM)
+    {
+      double sign= _d==Distribution::NEAR_PARALLEL ? 1.0 : -1.0;
+      double eps=std::pow(10.0,logEps(gen));
+      d={sign*s.m_x+eps*d.m_x,sign*s.m_y+eps*d.m_y,sign*s.m_z+eps*d.m_z};
+      d.normalize();
+    }
+    in.m_sx[i]=s.m_x; in.m_sy[i]=s.m_y; in.m_sz[i]=s.m_z;
+    in.m_dx[i]=d.m_x; in.m_dy[i]=d.m_y; in.m_dz[i]=d.m_z;
+  }
+  return in;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief how each construction lays out its matrix : toMat4 follows ngl (v' = v * M), the axis angle ones are
+/// written for column vectors (v' = M * v)
+//----------------------------------------------------------------------------------------------------------------------
+enum class Convention { ROW_VECTOR, COLUMN_VECTOR };
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief accumulates how well one path's rotations take each start onto its dest, the same measure for every path
+//----------------------------------------------------------------------------------------------------------------------
+struct ErrorStats
+{
+  double m_maxResidual=0.0;
+  double m_sumResidual=0.0;
+  double m_maxOrthonormal=0.0;
+  size_t m_count=0;
+  size_t m_nonFinite=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief _m in the column vector convention, evaluated in double against the exact pair
+  //----------------------------------------------------------------------------------------------------------------------
+  void add(const double _m[3][3], const DVec3 &_start, const DVec3 &_dest)
+  {
+    for(int r=0; r<3; ++r)
+      for(int c=0; c<3; ++c)
+        if(!std::isfinite(_m[r][c]))
+        {
+          ++m_nonFinite;
+          return;
+        }
+    const double start[3]={_start.m_x,_start.m_y,_start.m_z};
+    const double dest[3]={_dest.m_x,_dest.m_y,_dest.m_z};
+    double residual=0.0;
+    for(int r=0; r<3; ++r)
+    {
+      double e=_m[r][0]*start[0]+_m[r][1]*start[1]+_m[r][2]*start[2]-dest[r];
+      residual+=e*e;
+      for(int c=0; c<3; ++c)
+      {
+        double dot=_m[r][0]*_m[c][0]+_m[r][1]*_m[c][1]+_m[r][2]*_m[c][2];
+        m_maxOrthonormal=std::max(m_maxOrthonormal,std::fabs(dot-(r==c ? 1.0 : 0.0)));
+      }
+    }
+    residual=std::sqrt(residual);
+    m_maxResidual=std::max(m_maxResidual,residual);
+    m_sumResidual+=residual;
+    ++m_count;
+  }
+  double meanResidual() const { return m_count ? m_sumResidual/m_count : 0.0; }
+};
+
+void addMatrixError(ErrorStats &io_stats, const rmath::Mat4 &_m, Convention _convention, const DVec3 &_start,
+                    const DVec3 &_dest)
+{
+  double m[3][3];
+  for(int r=0; r<3; ++r)
+    for(int c=0; c<3; ++c)
+      m[r][c]= _convention==Convention::COLUMN_VECTOR ? _m.m_m[r][c] : _m.m_m[c][r];
+  io_stats.add(m,_start,_dest);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the rotation of (bank,heading,attitude) as eulerAngles defines them, heading about y then attitude about z
+/// then bank about x, in the column vector convention
+//----------------------------------------------------------------------------------------------------------------------
+void addEulerError(ErrorStats &io_stats, const rmath::Vec3 &_angles, const DVec3 &_start, const DVec3 &_dest)
+{
+  double cb=std::cos(_angles.m_x), sb=std::sin(_angles.m_x);
+  double ch=std::cos(_angles.m_y), sh=std::sin(_angles.m_y);
+  double ca=std::cos(_angles.m_z), sa=std::sin(_angles.m_z);
+  const double m[3][3]={
+    {ch*ca, sh*sb-ch*sa*cb, ch*sa*sb+sh*cb},
+    {sa,    ca*cb,          -ca*sb},
+    {-sh*ca,sh*sa*cb+ch*sb, -sh*sa*sb+ch*cb}
+  };
+  io_stats.add(m,_start,_dest);
+}
+
+struct Result
+{
+  std::string m_path;
+  Distribution m_distribution;
+  double m_rotationsPerSecond;
+  double m_cyclesPerRotation;
+  ErrorStats m_error;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief time _run over the whole input set _repeats times and keep the fastest
+//----------------------------------------------------------------------------------------------------------------------
+template<typename F>
+void timeIt(Result &io_result, size_t _count, int _repeats, F _run)
+{
+  double bestSeconds=std::numeric_limits<double>::max();
+  double bestCycles=0.0;
+  for(int r=0; r<_repeats; ++r)
+  {
+    auto start=std::chrono::steady_clock::now();
+#ifdef HAS_RDTSC
+    uint64_t c0=__rdtsc();
+#endif
+    _run();
+#ifdef HAS_RDTSC
+    uint64_t c1=__rdtsc();
+#endif
+    double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    if(seconds<bestSeconds)
+    {
+      bestSeconds=seconds;
+#ifdef HAS_RDTSC
+      bestCycles=static_cast<double>(c1-c0);
+#else
+      bestCycles=-1.0;
+#endif
+    }
+  }
+  io_result.m_rotationsPerSecond= bestSeconds>0.0 ? _count/bestSeconds : 0.0;
+  io_result.m_cyclesPerRotation= bestCycles<0.0 ? -1.0 : bestCycles/_count;
+}
+
+inline rmath::Vec3 axisFromPair(const Inputs &_in, size_t _i, float &o_angle)
+{
+  rmath::Vec3 s(_in.m_sx[_i],_in.m_sy[_i],_in.m_sz[_i]);
+  rmath::Vec3 d(_in.m_dx[_i],_in.m_dy[_i],_in.m_dz[_i]);
+  rmath::Vec3 axis=s.cross(d);
+  axis.normalize();
+  // rounding can take the dot of two unit floats just past 1
+  o_angle=std::acos(std::max(-1.0f,std::min(1.0f,s.dot(d))));
+  return axis;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the paths that use trig with the trig of tier A, the path names get _suffix
+//----------------------------------------------------------------------------------------------------------------------
+template<rmath::TrigAccuracy A>
+void benchmarkTrigPaths(const Inputs &_in, Distribution _d, const std::string &_suffix,
+                        std::vector<rmath::Mat4> &io_matrices, std::vector<rmath::Vec3> &io_angles, int _repeats,
+                        std::vector<Result> &o_results)
+{
+  const size_t count=_in.size();
+  // acos then cos / sin
+  {
+    Result r{"deriveMatrix"+_suffix,_d,0.0,0.0,ErrorStats()};
+    timeIt(r,count,_repeats,[&]()
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        io_matrices[i]=rmath::deriveRotMatrixToRotateV2toV1<A>(rmath::Vec3(_in.m_sx[i],_in.m_sy[i],_in.m_sz[i]),
+                                                               rmath::Vec3(_in.m_dx[i],_in.m_dy[i],_in.m_dz[i]));
+      }
+    });
+    for(size_t i=0; i<count; ++i)
+      addMatrixError(r.m_error,io_matrices[i],Convention::COLUMN_VECTOR,_in.start(i),_in.dest(i));
+    o_results.push_back(r);
+  }
+  // axis angle matrix
+  {
+    Result r{"axisAngle"+_suffix,_d,0.0,0.0,ErrorStats()};
+    timeIt(r,count,_repeats,[&]()
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        float angle;
+        rmath::Vec3 axis=axisFromPair(_in,i,angle);
+        io_matrices[i]=rmath::matrixFromAxisAngle<A>(axis,angle);
+      }
+    });
+    for(size_t i=0; i<count; ++i)
+      addMatrixError(r.m_error,io_matrices[i],Convention::COLUMN_VECTOR,_in.start(i),_in.dest(i));
+    o_results.push_back(r);
+  }
+  // euler angles
+  {
+    Result r{"toEuler"+_suffix,_d,0.0,0.0,ErrorStats()};
+    timeIt(r,count,_repeats,[&]()
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        float angle;
+        rmath::Vec3 axis=axisFromPair(_in,i,angle);
+        io_angles[i]=rmath::toEuler<A>(axis.m_x,axis.m_y,axis.m_z,angle);
+      }
+    });
+    for(size_t i=0; i<count; ++i)
+      addEulerError(r.m_error,io_angles[i],_in.start(i),_in.dest(i));
+    o_results.push_back(r);
+  }
+  // euler angles computed in float
+  {
+    Result r{"toEulerFloat"+_suffix,_d,0.0,0.0,ErrorStats()};
+    timeIt(r,count,_repeats,[&]()
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        float angle;
+        rmath::Vec3 axis=axisFromPair(_in,i,angle);
+        io_angles[i]=rmath::eulerAngles<A>(axis.m_x,axis.m_y,axis.m_z,angle);
+      }
+    });
+    for(size_t i=0; i<count; ++i)
+      addEulerError(r.m_error,io_angles[i],_in.start(i),_in.dest(i));
+    o_results.push_back(r);
+  }
+}
+
+void benchmarkDistribution(Distribution _d, size_t _count, int _repeats, std::vector<Result> &o_results)
+{
+  Inputs in=makeInputs(_d,_count,1234u+static_cast<unsigned int>(_d));
+  std::vector<rmath::Mat4> matrices(_count);
+  std::vector<rmath::Vec3> angles(_count);
+  std::vector<float> qs(_count),qx(_count),qy(_count),qz(_count);
+
+  // quaternion then matrix
+  {
+    Result r{"quatToMat4",_d,0.0,0.0,ErrorStats()};
+    timeIt(r,_count,_repeats,[&]()
+    {
+      for(size_t i=0; i<_count; ++i)
+      {
+        rmath::Quaternion q=rmath::rotationBetweenVectors(rmath::Vec3(in.m_sx[i],in.m_sy[i],in.m_sz[i]),
+                                                          rmath::Vec3(in.m_dx[i],in.m_dy[i],in.m_dz[i]));
+        matrices[i]=rmath::toMat4(q);
+      }
+    });
+    for(size_t i=0; i<_count; ++i)
+      addMatrixError(r.m_error,matrices[i],Convention::ROW_VECTOR,in.start(i),in.dest(i));
+    o_results.push_back(r);
+  }
+  // batched quaternion then matrix
+  {
+    Result r{"batchToMat4",_d,0.0,0.0,ErrorStats()};
+    timeIt(r,_count,_repeats,[&]()
+    {
+      rmath::rotationBetweenVectorsBatch({&in.m_sx[0],&in.m_sy[0],&in.m_sz[0]},
+                                         {&in.m_dx[0],&in.m_dy[0],&in.m_dz[0]},
+                                         {&qs[0],&qx[0],&qy[0],&qz[0]},_count);
+      for(size_t i=0; i<_count; ++i)
+        matrices[i]=rmath::toMat4(rmath::Quaternion(qs[i],qx[i],qy[i],qz[i]));
+    });
+    for(size_t i=0; i<_count; ++i)
+      addMatrixError(r.m_error,matrices[i],Convention::ROW_VECTOR,in.start(i),in.dest(i));
+    o_results.push_back(r);
+  }
+  benchmarkTrigPaths<rmath::TrigAccuracy::FULL>(in,_d,"",matrices,angles,_repeats,o_results);
+  benchmarkTrigPaths<rmath::TrigAccuracy::MEDIUM>(in,_d,"Medium",matrices,angles,_repeats,o_results);
+  benchmarkTrigPaths<rmath::TrigAccuracy::LOW>(in,_d,"Low",matrices,angles,_repeats,o_results);
+}
+
+struct AnimationResult
+{
+  std::string m_path;
+  size_t m_threads;
+  double m_samplesPerSecond;
+  double m_maxPositionError;
+  double m_maxAngleError;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the sampled poses of every track
+//----------------------------------------------------------------------------------------------------------------------
+struct Poses
+{
+  std::vector<float> m_data[7];
+  explicit Poses(size_t _count)
+  {
+    for(std::vector<float> &component : m_data)
+      component.resize(_count);
+  }
+  rmath::PoseStream stream()
+  {
+    return {&m_data[0][0],&m_data[1][0],&m_data[2][0],{&m_data[3][0],&m_data[4][0],&m_data[5][0],&m_data[6][0]}};
+  }
+};
+
+void benchmarkAnimation(size_t _tracks, int _repeats, std::vector<AnimationResult> &o_results)
+{
+  const int keysPerTrack=8;
+  const int timesPerRun=16;
+  std::mt19937 gen(4321u);
+  std::normal_distribution<float> normal;
+  std::uniform_real_distribution<float> jitter(0.0f,0.5f);
+  rmath::AnimationSet set;
+  for(size_t i=0; i<_tracks; ++i)
+  {
+    std::vector<rmath::PositionKey> positions;
+    std::vector<rmath::RotationKey> rotations;
+    for(int k=0; k<keysPerTrack; ++k)
+    {
+      positions.push_back({k+jitter(gen),rmath::Vec3(normal(gen),normal(gen),normal(gen))});
+      rmath::Quaternion q(normal(gen),normal(gen),normal(gen),normal(gen));
+      float len=std::sqrt(q.m_s*q.m_s+q.m_x*q.m_x+q.m_y*q.m_y+q.m_z*q.m_z);
+      rotations.push_back({k+jitter(gen),rmath::Quaternion(q.m_s/len,q.m_x/len,q.m_y/len,q.m_z/len)});
+    }
+    set.addTrack(positions,rotations);
+  }
+  float step=set.duration()/timesPerRun;
+  rmath::JobSystem jobs;
+
+  struct Path
+  {
+    const char *m_name;
+    rmath::RotationInterpolation m_mode;
+    bool m_reference;
+    size_t m_threads;
+  };
+  const Path paths[]={
+    {"referenceNlerp",rmath::RotationInterpolation::NLERP,true,1},
+    {"referenceSlerp",rmath::RotationInterpolation::SLERP,true,1},
+    {"batchNlerp",rmath::RotationInterpolation::NLERP,false,1},
+    {"batchSlerp",rmath::RotationInterpolation::SLERP,false,1},
+    {"batchSlerpThreaded",rmath::RotationInterpolation::SLERP,false,jobs.threadCount()}
+  };
+  Poses poses(_tracks);
+  Poses reference(_tracks);
+  for(const Path &path : paths)
+  {
+    Result timing;
+    rmath::PoseStream out=poses.stream();
+    timeIt(timing,_tracks*timesPerRun,_repeats,[&]()
+    {
+      for(int t=0; t<timesPerRun; ++t)
+      {
+        if(path.m_reference)
+          set.sampleReference(t*step,out,path.m_mode);
+        else
+          set.sample(t*step,out,path.m_mode,path.m_threads>1 ? &jobs : nullptr);
+      }
+    });
+    AnimationResult r{path.m_name,path.m_threads,timing.m_rotationsPerSecond,0.0,0.0};
+    // compare the last time sampled against the reference of the same mode
+    set.sampleReference((timesPerRun-1)*step,reference.stream(),path.m_mode);
+    for(size_t i=0; i<_tracks; ++i)
+    {
+      double flip=0.0;
+      for(int c=3; c<7; ++c)
+        flip+=static_cast<double>(poses.m_data[c][i])*reference.m_data[c][i];
+      double sign= flip<0.0 ? -1.0 : 1.0;
+      double chord=0.0;
+      for(int c=3; c<7; ++c)
+      {
+        double e=poses.m_data[c][i]-sign*reference.m_data[c][i];
+        chord+=e*e;
+      }
+      // angle of the rotation between the two, from the chord between the unit quaternions
+      r.m_maxAngleError=std::max(r.m_maxAngleError,4.0*std::asin(std::min(1.0,std::sqrt(chord)/2.0)));
+      for(int c=0; c<3; ++c)
+        r.m_maxPositionError=std::max(r.m_maxPositionError,
+                                      static_cast<double>(std::fabs(poses.m_data[c][i]-reference.m_data[c][i])));
+    }
+    o_results.push_back(r);
+  }
+}
+
+struct TrigResult
+{
+  std::string m_function;
+  const char *m_accuracy;
+  double m_valuesPerSecond;
+  double m_maxAbsError;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief time one array function of tier A over _x (and _y for atan2) and take its worst error against _reference
+//----------------------------------------------------------------------------------------------------------------------
+template<rmath::TrigAccuracy A>
+struct TrigTier
+{
+  static void run(const char *_accuracy, const std::vector<float> &_angles, const std::vector<float> &_unit,
+                  const std::vector<float> &_y, const std::vector<float> &_x, int _repeats,
+                  std::vector<TrigResult> &o_results)
+  {
+    typedef rmath::FastTrig<A> Trig;
+    const size_t count=_angles.size();
+    std::vector<float> out(count);
+    auto measure=[&](const char *_function, const std::vector<float> &_in, void (*_f)(const float *, float *, size_t),
+                     double (*_reference)(double))
+    {
+      Result timing;
+      timeIt(timing,count,_repeats,[&](){ _f(&_in[0],&out[0],count); });
+      TrigResult r{_function,_accuracy,timing.m_rotationsPerSecond,0.0};
+      for(size_t i=0; i<count; ++i)
+        r.m_maxAbsError=std::max(r.m_maxAbsError,std::fabs(out[i]-_reference(_in[i])));
+      o_results.push_back(r);
+    };
+    measure("sin",_angles,&Trig::sin,[](double _v){ return std::sin(_v); });
+    measure("cos",_angles,&Trig::cos,[](double _v){ return std::cos(_v); });
+    measure("acos",_unit,&Trig::acos,[](double _v){ return std::acos(_v); });
+    measure("asin",_unit,&Trig::asin,[](double _v){ return std::asin(_v); });
+
+    Result timing;
+    timeIt(timing,count,_repeats,[&](){ Trig::atan2(&_y[0],&_x[0],&out[0],count); });
+    TrigResult r{"atan2",_accuracy,timing.m_rotationsPerSecond,0.0};
+    for(size_t i=0; i<count; ++i)
+      r.m_maxAbsError=std::max(r.m_maxAbsError,std::fabs(out[i]-std::atan2(static_cast<double>(_y[i]),_x[i])));
+    o_results.push_back(r);
+  }
+};
+
+void benchmarkTrig(size_t _count, int _repeats, std::vector<TrigResult> &o_results)
+{
+  std::mt19937 gen(5678u);
+  // a few turns either way for sin / cos, every argument the rotation code can hand atan2
+  std::uniform_real_distribution<float> angle(-20.0f,20.0f);
+  std::uniform_real_distribution<float> unit(-1.0f,1.0f);
+  std::normal_distribution<float> normal;
+  std::vector<float> angles(_count),units(_count),y(_count),x(_count);
+  for(size_t i=0; i<_count; ++i)
+  {
+    angles[i]=angle(gen);
+    units[i]=unit(gen);
+    y[i]=normal(gen);
+    x[i]=normal(gen);
+  }
+  TrigTier<rmath::TrigAccuracy::FULL>::run("full",angles,units,y,x,_repeats,o_results);
+  TrigTier<rmath::TrigAccuracy::MEDIUM>::run("medium",angles,units,y,x,_repeats,o_results);
+  TrigTier<rmath::TrigAccuracy::LOW>::run("low",angles,units,y,x,_repeats,o_results);
+}
+
+struct JobResult
+{
+  size_t m_threads;
+  double m_objectsPerSecond;
+  double m_speedup;
+  size_t m_stolenChunks;
+};
+
+rmath::Mat4 multiply(const rmath::Mat4 &_a, const rmath::Mat4 &_b)
+{
+  rmath::Mat4 o;
+  for(int r=0; r<4; ++r)
+    for(int c=0; c<4; ++c)
+      o.m_m[r][c]=_a.m_m[r][0]*_b.m_m[0][c]+_a.m_m[r][1]*_b.m_m[1][c]+_a.m_m[r][2]*_b.m_m[2][c]+_a.m_m[r][3]*_b.m_m[3][c];
+  return o;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief inverse transpose of the upper 3x3 of _m, the cofactors over the determinant
+//----------------------------------------------------------------------------------------------------------------------
+void normalMatrix(const rmath::Mat4 &_m, float o_n[3][3])
+{
+  const float (*m)[4]=_m.m_m;
+  float cofactor[3][3];
+  for(int r=0; r<3; ++r)
+    for(int c=0; c<3; ++c)
+      cofactor[r][c]=m[(r+1)%3][(c+1)%3]*m[(r+2)%3][(c+2)%3]-m[(r+1)%3][(c+2)%3]*m[(r+2)%3][(c+1)%3];
+  float det=m[0][0]*cofactor[0][0]+m[0][1]*cofactor[0][1]+m[0][2]*cofactor[0][2];
+  float invDet=1.0f/det;
+  for(int r=0; r<3; ++r)
+    for(int c=0; c<3; ++c)
+      o_n[r][c]=cofactor[r][c]*invDet;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the scene's per-object update for _objects objects of a TransformStore on 1 to hardware threads : each
+/// chunk aligns its vector pairs into the store's rotations, then builds the model (the store's world matrix with a
+/// grid translation), MVP and normal matrices
+//----------------------------------------------------------------------------------------------------------------------
+void benchmarkJobs(size_t _objects, int _repeats, std::vector<JobResult> &o_results)
+{
+  Inputs in=makeInputs(Distribution::UNIFORM,_objects,9876u);
+  const size_t grid=static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(_objects))));
+  rmath::TransformStore transforms;
+  transforms.reserve(_objects);
+  for(size_t i=0; i<_objects; ++i)
+    transforms.create(rmath::Vec3(static_cast<float>(i%grid),static_cast<float>(i/grid%grid),
+                                  static_cast<float>(i/(grid*grid))));
+  rmath::Mat4 root;
+  root.m_m[3][2]=-10.0f;
+  transforms.setRoot(root);
+  rmath::QuaternionStream q=transforms.poses().m_rotation;
+  std::vector<rmath::Mat4> model(_objects);
+  std::vector<rmath::Mat4> mvp(_objects);
+  std::vector<float> normals(_objects*9);
+  rmath::Mat4 viewProject;
+  viewProject.m_m[2][3]=-1.0f;
+  viewProject.m_m[3][2]=-0.2f;
+  viewProject.m_m[3][3]=0.0f;
+
+  auto update=[&](size_t _begin, size_t _end)
+  {
+    size_t count=_end-_begin;
+    rmath::rotationBetweenVectorsBatch({&in.m_sx[_begin],&in.m_sy[_begin],&in.m_sz[_begin]},
+                                       {&in.m_dx[_begin],&in.m_dy[_begin],&in.m_dz[_begin]},
+                                       {q.m_s+_begin,q.m_x+_begin,q.m_y+_begin,q.m_z+_begin},count);
+    transforms.worldMatrices(_begin,_end,&model[_begin]);
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      mvp[i]=multiply(model[i],viewProject);
+      normalMatrix(model[i],reinterpret_cast<float (*)[3]>(&normals[i*9]));
+    }
+  };
+
+  const size_t hardwareThreads=std::max(1u,std::thread::hardware_concurrency());
+  double single=0.0;
+  for(size_t threads=1; threads<=hardwareThreads; ++threads)
+  {
+    rmath::JobSystem jobs(threads);
+    Result timing;
+    timeIt(timing,_objects,_repeats,[&](){ jobs.parallelFor(_objects,64,update); });
+    if(threads==1)
+      single=timing.m_rotationsPerSecond;
+    o_results.push_back({threads,timing.m_rotationsPerSecond,
+                         single>0.0 ? timing.m_rotationsPerSecond/single : 0.0,jobs.stolenChunks()});
+  }
+}
+
+struct CullResult
+{
+  size_t m_spheres;
+  size_t m_visible;
+  double m_spheresPerSecond;
+  size_t m_mismatches;
+};
+
+void benchmarkCull(size_t _spheres, int _repeats, CullResult &o_result)
+{
+  std::mt19937 gen(2468u);
+  // a wide field around the camera so most spheres are off screen, as in the large scenes
+  std::uniform_real_distribution<float> position(-200.0f,200.0f);
+  std::uniform_real_distribution<float> radius(0.5f,2.0f);
+  std::vector<float> x(_spheres),y(_spheres),z(_spheres),r(_spheres);
+  for(size_t i=0; i<_spheres; ++i)
+  {
+    x[i]=position(gen);
+    y[i]=position(gen);
+    z[i]=position(gen);
+    r[i]=radius(gen);
+  }
+  // 45 degree perspective looking down -z, as the demo camera, in the row vector (ngl) layout
+  const float f=1.0f/std::tan(22.5f*static_cast<float>(M_PI)/180.0f);
+  const float nearPlane=0.05f;
+  const float farPlane=350.0f;
+  rmath::Mat4 project;
+  project.m_m[0][0]=f/1.25f;
+  project.m_m[1][1]=f;
+  project.m_m[2][2]=(farPlane+nearPlane)/(nearPlane-farPlane);
+  project.m_m[2][3]=-1.0f;
+  project.m_m[3][2]=2.0f*farPlane*nearPlane/(nearPlane-farPlane);
+  project.m_m[3][3]=0.0f;
+  rmath::Frustum frustum=rmath::frustumFromMatrix(project);
+
+  std::vector<uint32_t> visible(_spheres);
+  Result timing;
+  timeIt(timing,_spheres,_repeats,[&]()
+  {
+    o_result.m_visible=rmath::cullSpheres(frustum,{&x[0],&y[0],&z[0]},&r[0],0,_spheres,&visible[0]);
+  });
+  o_result.m_spheres=_spheres;
+  o_result.m_spheresPerSecond=timing.m_rotationsPerSecond;
+  o_result.m_mismatches=0;
+  size_t next=0;
+  for(size_t i=0; i<_spheres; ++i)
+  {
+    bool inside=true;
+    for(const float *plane : frustum.m_planes)
+      inside=inside && plane[0]*x[i]+plane[1]*y[i]+plane[2]*z[i]+plane[3]+r[i]>=0.0f;
+    bool listed=next<o_result.m_visible && visible[next]==i;
+    if(listed)
+      ++next;
+    if(inside!=listed)
+      ++o_result.m_mismatches;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the sizes and repeats every section reads from the command line
+//----------------------------------------------------------------------------------------------------------------------
+struct Options
+{
+  size_t m_count;
+  size_t m_tracks;
+  size_t m_objects;
+  int m_repeats;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief each section runs its benchmarks and writes them as one JSON object, indented to sit inside the top level
+//----------------------------------------------------------------------------------------------------------------------
+void rotationSection(std::ostream &_out, const Options &_options)
+{
+  std::vector<Result> results;
+  for(Distribution d : {Distribution::UNIFORM,Distribution::NEAR_PARALLEL,Distribution::NEAR_ANTIPARALLEL})
+    benchmarkDistribution(d,_options.m_count,_options.m_repeats,results);
+  _out<<"{\n"
+      <<"    \"count\": "<<_options.m_count<<",\n"
+      <<"    \"results\": [\n";
+  for(size_t i=0; i<results.size(); ++i)
+  {
+    const Result &r=results[i];
+    _out<<"      {\"path\": \""<<r.m_path<<"\", "
+        <<"\"distribution\": \""<<distributionName(r.m_distribution)<<"\", "
+        <<"\"rotationsPerSecond\": "<<r.m_rotationsPerSecond<<", "
+        <<"\"cyclesPerRotation\": "<<r.m_cyclesPerRotation<<", "
+        <<"\"maxResidual\": "<<r.m_error.m_maxResidual<<", "
+        <<"\"meanResidual\": "<<r.m_error.meanResidual()<<", "
+        <<"\"maxOrthonormalError\": "<<r.m_error.m_maxOrthonormal<<", "
+        <<"\"nonFiniteValues\": "<<r.m_error.m_nonFinite<<"}"
+        <<(i+1<results.size() ? ",\n" : "\n");
+  }
+  _out<<"    ]\n"
+      <<"  }";
+}
+
+void animationSection(std::ostream &_out, const Options &_options)
+{
+  std::vector<AnimationResult> results;
+  benchmarkAnimation(_options.m_tracks,_options.m_repeats,results);
+  _out<<"{\n"
+      <<"    \"tracks\": "<<_options.m_tracks<<",\n"
+      <<"    \"results\": [\n";
+  for(size_t i=0; i<results.size(); ++i)
+  {
+    const AnimationResult &r=results[i];
+    _out<<"      {\"path\": \""<<r.m_path<<"\", "
+        <<"\"threads\": "<<r.m_threads<<", "
+        <<"\"samplesPerSecond\": "<<r.m_samplesPerSecond<<", "
+        <<"\"maxPositionError\": "<<r.m_maxPositionError<<", "
+        <<"\"maxAngleError\": "<<r.m_maxAngleError<<"}"
+        <<(i+1<results.size() ? ",\n" : "\n");
+  }
+  _out<<"    ]\n"
+      <<"  }";
+}
+
+void trigSection(std::ostream &_out, const Options &_options)
+{
+  std::vector<TrigResult> results;
+  benchmarkTrig(_options.m_count,_options.m_repeats,results);
+  _out<<"{\n"
+      <<"    \"count\": "<<_options.m_count<<",\n"
+      <<"    \"results\": [\n";
+  for(size_t i=0; i<results.size(); ++i)
+  {
+    const TrigResult &r=results[i];
+    _out<<"      {\"function\": \""<<r.m_function<<"\", "
+        <<"\"accuracy\": \""<<r.m_accuracy<<"\", "
+        <<"\"valuesPerSecond\": "<<r.m_valuesPerSecond<<", "
+        <<"\"maxAbsError\": "<<r.m_maxAbsError<<"}"
+        <<(i+1<results.size() ? ",\n" : "\n");
+  }
+  _out<<"    ]\n"
+      <<"  }";
+}
+
+void jobsSection(std::ostream &_out, const Options &_options)
+{
+  std::vector<JobResult> results;
+  benchmarkJobs(_options.m_objects,_options.m_repeats,results);
+  _out<<"{\n"
+      <<"    \"objects\": "<<_options.m_objects<<",\n"
+      <<"    \"results\": [\n";
+  for(size_t i=0; i<results.size(); ++i)
+  {
+    const JobResult &r=results[i];
+    _out<<"      {\"threads\": "<<r.m_threads<<", "
+        <<"\"objectsPerSecond\": "<<r.m_objectsPerSecond<<", "
+        <<"\"speedup\": "<<r.m_speedup<<", "
+        <<"\"stolenChunks\": "<<r.m_stolenChunks<<"}"
+        <<(i+1<results.size() ? ",\n" : "\n");
+  }
+  _out<<"    ]\n"
+      <<"  }";
+}
+
+void cullSection(std::ostream &_out, const Options &_options)
+{
+  CullResult result;
+  benchmarkCull(_options.m_objects,_options.m_repeats,result);
+  _out<<"{\"spheres\": "<<result.m_spheres<<", "
+      <<"\"visible\": "<<result.m_visible<<", "
+      <<"\"spheresPerSecond\": "<<result.m_spheresPerSecond<<", "
+      <<"\"mismatches\": "<<result.m_mismatches<<"}";
+}
+
+struct Section
+{
+  const char *m_name;
+  void (*m_run)(std::ostream &_out, const Options &_options);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief every section in the order they run and are written, --section picks a subset by name
+//----------------------------------------------------------------------------------------------------------------------
+const Section s_sections[]={
+  {"rotation",rotationSection},
+  {"animation",animationSection},
+  {"trig",trigSection},
+  {"jobs",jobsSection},
+  {"cull",cullSection}
+};
+const size_t SECTION_COUNT=sizeof(s_sections)/sizeof(s_sections[0]);
+
+void writeJSON(std::ostream &_out, const Options &_options, const std::vector<bool> &_selected)
+{
+  _out<<"{\n"
+      <<"  \"isa\": \""<<rmath::rotationBatchISA()<<"\",\n"
+      <<"  \"repeats\": "<<_options.m_repeats;
+  for(size_t i=0; i<SECTION_COUNT; ++i)
+  {
+    if(!_selected[i])
+      continue;
+    _out<<",\n  \""<<s_sections[i].m_name<<"\": ";
+    s_sections[i].m_run(_out,_options);
+  }
+  _out<<"\n}\n";
+}
+
+void usage()
+{
+  std::cerr<<"usage : rotbench [-n pairs] [-a animation tracks] [-j job objects] [-r repeats] [-o output.json]"
+             " [--section name]...\n"
+             "sections :";
+  for(const Section &section : s_sections)
+    std::cerr<<" "<<section.m_name;
+  std::cerr<<", all of them when no --section is given\n";
+}
+
+} // end anon namespace
+
+int main(int argc, char **argv)
+{
+  Options options;
+  options.m_count=1<<18;
+  options.m_tracks=1<<14;
+  options.m_objects=100000;
+  options.m_repeats=5;
+  std::string outputName;
+  std::vector<bool> selected(SECTION_COUNT,false);
+  bool anySelected=false;
+  for(int i=1; i<argc; i+=2)
+  {
+    std::string arg=argv[i];
+    if(i+1>=argc)
+    {
+      std::cerr<<"rotbench : "<<arg<<" needs a value\n";
+      usage();
+      return EXIT_FAILURE;
+    }
+    std::string value=argv[i+1];
+    if(arg=="-n")
+      options.m_count=static_cast<size_t>(std::atol(value.c_str()));
+    else if(arg=="-a")
+      options.m_tracks=static_cast<size_t>(std::atol(value.c_str()));
+    else if(arg=="-j")
+      options.m_objects=static_cast<size_t>(std::atol(value.c_str()));
+    else if(arg=="-r")
+      options.m_repeats=std::atoi(value.c_str());
+    else if(arg=="-o")
+      outputName=value;
+    else if(arg=="--section")
+    {
+      size_t s=0;
+      while(s<SECTION_COUNT && value!=s_sections[s].m_name)
+        ++s;
+      if(s==SECTION_COUNT)
+      {
+        std::cerr<<"rotbench : unknown section "<<value<<"\n";
+        usage();
+        return EXIT_FAILURE;
+      }
+      selected[s]=true;
+      anySelected=true;
+    }
+    else
+    {
+      std::cerr<<"rotbench : unknown option "<<arg<<"\n";
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+  if(options.m_count==0 || options.m_tracks==0 || options.m_objects==0 || options.m_repeats<=0)
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+  if(!anySelected)
+    selected.assign(SECTION_COUNT,true);
+
+  if(outputName.empty())
+  {
+    writeJSON(std::cout,options,selected);
+  }
+  else
+  {
+    std::ofstream out(outputName.c_str());
+    if(!out)
+    {
+      std::cerr<<"rotbench : can't open "<<outputName<<"\n";
+      return EXIT_FAILURE;
+    }
+    writeJSON(out,options,selected);
+  }
+  return EXIT_SUCCESS;
+}
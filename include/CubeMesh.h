@@ -0,0 +1,70 @@
+#ifndef CUBEMESH_H__
+#define CUBEMESH_H__
+
+#include "MeshRegistry.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CubeMesh.h
+/// @brief the unit (-1..1) cube as an indexed, interleaved mesh generated at compile time. Each face has its own four
+/// vertices so the normals stay flat, giving 24 vertices and 36 indices instead of 36 unshared vertices.
+//----------------------------------------------------------------------------------------------------------------------
+
+const static int CUBE_VERTEX_COUNT=24;
+const static int CUBE_INDEX_COUNT=36;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the bounding sphere about the centre reaches the corners, sqrt(3)
+//----------------------------------------------------------------------------------------------------------------------
+const static float CUBE_BOUNDING_RADIUS=1.73205081f;
+
+struct CubeMesh
+{
+  MeshVertex m_vertices[CUBE_VERTEX_COUNT];
+  GLushort m_indices[CUBE_INDEX_COUNT];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief build the cube, face f lies on axis f/2 on the positive side when f is odd, its corners go anticlockwise
+/// seen from outside so the triangles are front facing
+//----------------------------------------------------------------------------------------------------------------------
+constexpr CubeMesh makeCubeMesh()
+{
+  CubeMesh mesh{};
+  // corner offsets along the two face axes, anticlockwise
+  const float cornerU[4]={-1.0f,1.0f,1.0f,-1.0f};
+  const float cornerV[4]={-1.0f,-1.0f,1.0f,1.0f};
+  for(int face=0; face<6; ++face)
+  {
+    int axis=face/2;
+    float side=(face%2)!=0 ? 1.0f : -1.0f;
+    // u, v, axis is a right handed frame so anticlockwise in u, v faces +axis
+    int u=(axis+1)%3;
+    int v=(axis+2)%3;
+    for(int corner=0; corner<4; ++corner)
+    {
+      MeshVertex &vertex=mesh.m_vertices[face*4+corner];
+      vertex.m_position[axis]=side;
+      vertex.m_position[u]=cornerU[corner];
+      vertex.m_position[v]=cornerV[corner];
+      vertex.m_normal[axis]=side;
+    }
+    GLushort first=static_cast<GLushort>(face*4);
+    GLushort *index=&mesh.m_indices[face*6];
+    // the negative faces look down -axis so their winding is reversed
+    int a=side>0.0f ? 1 : 2;
+    int b=side>0.0f ? 2 : 1;
+    index[0]=first;
+    index[1]=static_cast<GLushort>(first+a);
+    index[2]=static_cast<GLushort>(first+b);
+    index[3]=first;
+    index[4]=static_cast<GLushort>(first+a+1);
+    index[5]=static_cast<GLushort>(first+b+1);
+  }
+  return mesh;
+}
+
+constexpr CubeMesh CUBE_MESH=makeCubeMesh();
+
+static_assert(CUBE_MESH.m_vertices[CUBE_VERTEX_COUNT-1].m_position[2]==1.0f,"cube generated at compile time");
+static_assert(CUBE_MESH.m_indices[CUBE_INDEX_COUNT-1]==CUBE_VERTEX_COUNT-1,"cube indices generated at compile time");
+
+#endif
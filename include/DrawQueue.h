@@ -0,0 +1,111 @@
+#ifndef DRAWQUEUE_H__
+#define DRAWQUEUE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DrawQueue.h
+/// @brief collects a frame's draws and submits them grouped by state. Each draw is keyed by a packed 64 bit value,
+/// program in the top byte, then material, mesh and view depth, so sorting the keys puts draws sharing a program
+/// together, within that those sharing a material, and so on, with the nearest first inside a group so early depth
+/// testing rejects more. The sort is an LSD radix sort over the key bytes into a preallocated buffer, bytes that are
+/// the same in every key are skipped. submit then walks the sorted draws and only calls the Backend when the
+/// program, material or mesh actually changes, counting the changes saved against setting all three per draw.
+/// Nothing here touches GL, the Backend does.
+/// @class DrawQueue
+//----------------------------------------------------------------------------------------------------------------------
+class DrawQueue
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one draw, the state it needs is in m_key
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Item
+    {
+      uint64_t m_key;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the caller's name for the per draw data (the transform block slot in NGLScene)
+      //----------------------------------------------------------------------------------------------------------------------
+      uint32_t m_transform;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief instance count of an instanced draw, 0 for a plain draw
+      //----------------------------------------------------------------------------------------------------------------------
+      uint32_t m_instances;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the state changes and the draw itself, m_useProgram is always followed by m_useMaterial since material
+    /// uniforms belong to the program
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Backend
+    {
+      std::function<void(uint32_t _program)> m_useProgram;
+      std::function<void(uint32_t _material)> m_useMaterial;
+      std::function<void(uint32_t _mesh)> m_bindMesh;
+      std::function<void(const Item &_item)> m_draw;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief counts for the last submit, m_skipped is 3 * m_draws - m_stateChanges
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      size_t m_draws;
+      size_t m_stateChanges;
+      size_t m_skipped;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief widths of the key fields, ids must fit them
+    //----------------------------------------------------------------------------------------------------------------------
+    static const int PROGRAM_BITS=8;
+    static const int MATERIAL_BITS=8;
+    static const int MESH_BITS=16;
+    static const int DEPTH_BITS=32;
+
+    DrawQueue();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make room for _count draws so pushing up to that many allocates nothing
+    //----------------------------------------------------------------------------------------------------------------------
+    void reserve(size_t _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drop the draws of the last frame, keeps the storage
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear() { m_items.clear(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief queue a draw
+    /// @param [in] _depth distance in front of the camera, any float orders correctly
+    /// @param [in] _instances 0 for a plain draw
+    //----------------------------------------------------------------------------------------------------------------------
+    void push(uint32_t _program, uint32_t _material, uint32_t _mesh, float _depth, uint32_t _transform,
+              uint32_t _instances=0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief order the queued draws by key
+    //----------------------------------------------------------------------------------------------------------------------
+    void sort();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief issue the draws in their current order, nothing is assumed bound beforehand
+    //----------------------------------------------------------------------------------------------------------------------
+    const Stats &submit(const Backend &_backend);
+    const Stats &stats() const { return m_stats; }
+    size_t size() const { return m_items.size(); }
+    const Item &operator[](size_t _index) const { return m_items[_index]; }
+
+    static uint64_t makeKey(uint32_t _program, uint32_t _material, uint32_t _mesh, float _depth);
+    static uint32_t programOf(uint64_t _key) { return static_cast<uint32_t>(_key>>(64-PROGRAM_BITS)); }
+    static uint32_t materialOf(uint64_t _key)
+    {
+      return static_cast<uint32_t>(_key>>(MESH_BITS+DEPTH_BITS))&((1u<<MATERIAL_BITS)-1);
+    }
+    static uint32_t meshOf(uint64_t _key) { return static_cast<uint32_t>(_key>>DEPTH_BITS)&((1u<<MESH_BITS)-1); }
+
+  private:
+    std::vector<Item> m_items;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the other half of each radix pass
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Item> m_scratch;
+    Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef FRAMEPROFILER_H__
+#define FRAMEPROFILER_H__
+
+#include <ngl/Types.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameProfiler.h
+/// @brief per frame CPU section timings and whole frame GPU time for the HUD. GPU time comes from two GL_TIME_ELAPSED
+/// queries used alternately, a result is only read once GL reports it available so the CPU never waits on the GPU,
+/// frames whose result was not ready in time are simply left without a GPU time.
+/// @class FrameProfiler
+//----------------------------------------------------------------------------------------------------------------------
+class FrameProfiler
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the parts of paintGL that are timed
+    //----------------------------------------------------------------------------------------------------------------------
+    enum Section
+    {
+      MATRICES=0,
+      CULL,
+      UPLOADS,
+      INSTANCES,
+      SORT,
+      DRAW,
+      SECTIONCOUNT
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rolling statistics in milliseconds
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stats
+    {
+      double m_mean;
+      double m_p99;
+      size_t m_samples;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief times the enclosing scope into one section, sections may be entered more than once a frame
+    //----------------------------------------------------------------------------------------------------------------------
+    class ScopedTimer
+    {
+      public:
+        ScopedTimer(FrameProfiler &_profiler, Section _section) :
+          m_profiler(_profiler), m_section(_section), m_start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer()
+        {
+          m_profiler.addSectionTime(m_section,std::chrono::steady_clock::now()-m_start);
+        }
+      private:
+        FrameProfiler &m_profiler;
+        Section m_section;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @param [in] _historyFrames how many frames the rolling stats and the CSV cover
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit FrameProfiler(size_t _historyFrames=600);
+    ~FrameProfiler();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the timer queries, needs a current context
+    //----------------------------------------------------------------------------------------------------------------------
+    void initGL();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start timing a frame, collects the GPU time of an earlier frame if it is ready
+    //----------------------------------------------------------------------------------------------------------------------
+    void beginFrame();
+    void endFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add time to a section of the current frame, normally via ScopedTimer
+    //----------------------------------------------------------------------------------------------------------------------
+    void addSectionTime(Section _section, std::chrono::steady_clock::duration _time);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rolling stats over the history, refreshed every few frames rather than on every call
+    //----------------------------------------------------------------------------------------------------------------------
+    const Stats &cpuFrameStats() const { return m_cpuStats; }
+    const Stats &gpuFrameStats() const { return m_gpuStats; }
+    const Stats &sectionStats(Section _section) const { return m_sectionStats[_section]; }
+    static const char *sectionName(Section _section);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write one line per frame of the history, oldest first
+    /// @returns false if the file can't be written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool writeCSV(const std::string &_path) const;
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief everything measured for one frame, times in milliseconds, a negative GPU time means not known
+    //----------------------------------------------------------------------------------------------------------------------
+    struct FrameTiming
+    {
+      uint32_t m_frame;
+      float m_cpuMs;
+      float m_gpuMs;
+      float m_sectionMs[SECTIONCOUNT];
+    };
+    void collectGPUResult(int _query);
+    void updateStats();
+    Stats computeStats(float FrameTiming::*_field) const;
+    Stats computeSectionStats(Section _section) const;
+    Stats statsFromScratch(size_t _count) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ring of the last m_history.size() frames, frame n lives at n % size
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<FrameTiming> m_history;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief preallocated sort space for the percentiles
+    //----------------------------------------------------------------------------------------------------------------------
+    mutable std::vector<float> m_scratch;
+    uint32_t m_frame;
+    size_t m_framesRecorded;
+    std::chrono::steady_clock::time_point m_frameStart;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the two GL_TIME_ELAPSED queries, the frame each one is measuring and if a result is outstanding
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_queries[2];
+    uint32_t m_queryFrame[2];
+    bool m_queryPending[2];
+    Stats m_cpuStats;
+    Stats m_gpuStats;
+    Stats m_sectionStats[SECTIONCOUNT];
+};
+
+#endif
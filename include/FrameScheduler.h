@@ -0,0 +1,65 @@
+#ifndef FRAMESCHEDULER_H__
+#define FRAMESCHEDULER_H__
+
+#include <QElapsedTimer>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrameScheduler.h
+/// @brief fixed timestep accumulator for the demo animation. Wall clock time is banked every frame and paid out in
+/// whole simulation steps, so the animation runs at the same speed however fast the machine draws, and the caller
+/// can ask how long until the next step is due to sleep until then instead of spinning.
+/// @class FrameScheduler
+//----------------------------------------------------------------------------------------------------------------------
+class FrameScheduler
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param [in] _stepMs the length of one simulation step in milliseconds
+    /// @param [in] _maxStepsPerFrame cap on the steps paid out at once so a long stall (debugger, window drag)
+    /// does not make the animation jump
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit FrameScheduler(int _stepMs=100, int _maxStepsPerFrame=5);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start (or restart) the clock with an empty accumulator
+    //----------------------------------------------------------------------------------------------------------------------
+    void start();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bank the time since the last call
+    /// @returns the number of whole steps the simulation should now advance
+    //----------------------------------------------------------------------------------------------------------------------
+    int advance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief milliseconds until the next step is due, -1 when paused
+    //----------------------------------------------------------------------------------------------------------------------
+    int msUntilNextStep() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stop banking time, advance returns 0 until resumed
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPaused(bool _paused);
+    bool isPaused() const { return m_paused; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make advance return exactly _steps every call regardless of the clock (headless and replay runs),
+    /// 0 goes back to the clock
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedSteps(int _steps) { m_fixedSteps=_steps; }
+    int stepMs() const { return m_stepMs; }
+
+  private:
+    QElapsedTimer m_clock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief m_clock reading at the last advance
+    //----------------------------------------------------------------------------------------------------------------------
+    qint64 m_lastNs;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief banked time not yet paid out as steps
+    //----------------------------------------------------------------------------------------------------------------------
+    qint64 m_accumulatorNs;
+    qint64 m_stepNs;
+    int m_stepMs;
+    int m_maxStepsPerFrame;
+    int m_fixedSteps;
+    bool m_paused;
+};
+
+#endif
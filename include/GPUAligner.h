@@ -0,0 +1,98 @@
+#ifndef GPUALIGNER_H__
+#define GPUALIGNER_H__
+
+#include <ngl/Types.h>
+#include <ngl/Vec3.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GPUAligner.h
+/// @brief optional GL 4.3 compute pass that solves start / dest vector pair alignments on the GPU and writes the
+/// quaternions straight into the instance buffer consumed by the instanced draw, so the data never goes back
+/// through the CPU. Like the CPU path only a chosen subset of the instances (the visible ones) is written, packed
+/// front to back with its translation so the instanced draw needs no gaps skipped. Only core 4.3 features are used so
+/// it also runs on Mesa llvmpipe.
+/// @class GPUAligner
+//----------------------------------------------------------------------------------------------------------------------
+class GPUAligner
+{
+  public:
+    GPUAligner();
+    ~GPUAligner();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the compute program and upload the pairs, needs a current context
+    /// @param [in] _shaderPath the compute shader source (shaders/AlignCompute.glsl)
+    /// @param [in] _instanceBuffer buffer of InstanceData the rotations are written to
+    /// @param [in] _starts the vectors to rotate from, one per instance
+    /// @param [in] _dests the vectors to rotate to, one per instance
+    /// @param [in] _translations the instance positions written next to each rotation
+    /// @returns false if the context is older than 4.3 or the shader fails to build, the caller should then keep
+    /// using the CPU path
+    //----------------------------------------------------------------------------------------------------------------------
+    bool init(const std::string &_shaderPath, GLuint _instanceBuffer,
+              const std::vector<ngl::Vec3> &_starts, const std::vector<ngl::Vec3> &_dests,
+              const std::vector<ngl::Vec3> &_translations);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replace the stored pairs (same count as init), every pair is selected again
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPairs(const std::vector<ngl::Vec3> &_starts, const std::vector<ngl::Vec3> &_dests,
+                  const std::vector<ngl::Vec3> &_translations);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief choose the pairs the next dispatches write, instance i of the buffer gets pair _pairs[i]-_base
+    /// @param [in] _pairs ascending indices, as cullSpheres lists them
+    /// @param [in] _count how many, the number of instances to draw
+    /// @param [in] _base subtracted from each index, where the instances start in the caller's numbering
+    //----------------------------------------------------------------------------------------------------------------------
+    void select(const uint32_t *_pairs, size_t _count, uint32_t _base);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief align the selected instances to their stored dests
+    //----------------------------------------------------------------------------------------------------------------------
+    void dispatch();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief align the selected instances to _target, ignoring the stored dests
+    //----------------------------------------------------------------------------------------------------------------------
+    void dispatch(const ngl::Vec3 &_target);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many instances the dispatches write, from the front of the instance buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t selectedCount() const { return m_selectedCount; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true once init has succeeded
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isAvailable() const { return m_program!=0; }
+
+  private:
+    void dispatch(bool _overrideTarget, const ngl::Vec3 &_target);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the compute program
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_program;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief shader storage buffer of start / dest pairs and their translations (three vec4 per pair)
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_pairBuffer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief shader storage buffer of the selected pair indices, one uint per instance written
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_selectionBuffer;
+    GLuint m_selectedCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instance buffer we write into, not owned
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_instanceBuffer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of pairs / instances
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_count;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uniform locations resolved once at init
+    //----------------------------------------------------------------------------------------------------------------------
+    GLint m_countLocation;
+    GLint m_overrideTargetLocation;
+    GLint m_targetLocation;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef INPUTLOG_H__
+#define INPUTLOG_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file InputLog.h
+/// @brief record and replay of everything that changes the scene between frames: mouse, wheel and key input and the
+/// number of simulation steps each frame took. Replaying a recording draws exactly the same frames whatever the
+/// clock does, so two builds can be timed on the same sequence.
+/// The file is an 8 byte header ("RINP", uint32 version) followed by InputEvent records in the order they happened.
+/// Version 2 added RESIZE, version 1 recordings are refused since the camera shape they were drawn with is unknown.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief what an InputEvent records and how m_button / m_x / m_y are used
+//----------------------------------------------------------------------------------------------------------------------
+enum class InputEventType : uint8_t
+{
+  STEPS=0,          ///< m_x simulation steps run this frame
+  MOUSEPRESS,       ///< m_button the button pressed, m_x m_y position
+  MOUSERELEASE,     ///< m_button the button released, m_x m_y position
+  MOUSEMOVE,        ///< m_button the buttons held, m_x m_y position
+  WHEEL,            ///< m_x wheel delta
+  KEY,              ///< m_x Qt key code
+  END,              ///< the frame the recording stopped on, replay runs up to it
+  RESIZE            ///< m_x m_y the size the camera was shaped for, after END so the older values are unchanged
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one 16 byte input record, written to the file as is
+//----------------------------------------------------------------------------------------------------------------------
+struct InputEvent
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the event is applied before this frame is drawn
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t m_frame;
+  InputEventType m_type;
+  uint8_t m_button;
+  uint16_t m_pad;
+  int32_t m_x;
+  int32_t m_y;
+};
+
+static_assert(sizeof(InputEvent)==16,"InputEvent is written to the input file as a 16 byte record");
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class InputRecorder
+/// @brief appends InputEvents to a file, does nothing until start is called
+//----------------------------------------------------------------------------------------------------------------------
+class InputRecorder
+{
+  public:
+    InputRecorder();
+    ~InputRecorder();
+    InputRecorder(const InputRecorder &)=delete;
+    InputRecorder &operator=(const InputRecorder &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief open _path and write the header
+    /// @returns false if the file can't be opened, recording then stays off
+    //----------------------------------------------------------------------------------------------------------------------
+    bool start(const std::string &_path);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write an END event for _frame and close the file
+    //----------------------------------------------------------------------------------------------------------------------
+    void stop(uint32_t _frame);
+    bool isRecording() const { return m_file!=nullptr; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief append an event, a no-op when not recording
+    //----------------------------------------------------------------------------------------------------------------------
+    void record(InputEventType _type, uint32_t _frame, int _button=0, int _x=0, int _y=0);
+
+  private:
+    std::FILE *m_file;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class InputReplayer
+/// @brief reads a recording made by InputRecorder and hands its events back frame by frame
+//----------------------------------------------------------------------------------------------------------------------
+class InputReplayer
+{
+  public:
+    InputReplayer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read the whole of _path
+    /// @returns false if the file is missing or not a recording, the replayer then stays inactive
+    //----------------------------------------------------------------------------------------------------------------------
+    bool load(const std::string &_path);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true once a recording has been loaded, live input should then be ignored
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isActive() const { return m_active; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the next event due at or before _frame
+    /// @returns nullptr when nothing more is due this frame
+    //----------------------------------------------------------------------------------------------------------------------
+    const InputEvent *next(uint32_t _frame);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of frames the recording covers, replay is done once this many have been drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t frameCount() const;
+
+  private:
+    std::vector<InputEvent> m_events;
+    size_t m_next;
+    bool m_active;
+};
+
+#endif
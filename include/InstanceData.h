@@ -0,0 +1,27 @@
+#ifndef INSTANCEDATA_H__
+#define INSTANCEDATA_H__
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file InstanceData.h
+/// @brief layout of one element of the per instance vertex buffer read by PhongVertex.glsl
+/// attribute 4 is the rotation, attribute 5 the translation, both with a divisor of 1
+//----------------------------------------------------------------------------------------------------------------------
+struct InstanceData
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the rotation quaternion stored x,y,z,s so it maps onto a glsl vec4 (xyz vector part, w scalar)
+  //----------------------------------------------------------------------------------------------------------------------
+  float m_rotation[4];
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world position of the instance, applied after the rotation
+  //----------------------------------------------------------------------------------------------------------------------
+  float m_translation[3];
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief pads the stride to 32 bytes so every instance starts on a 16 byte boundary
+  //----------------------------------------------------------------------------------------------------------------------
+  float m_pad;
+};
+
+static_assert(sizeof(InstanceData)==32,"InstanceData must match the 32 byte stride used by the shaders");
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef MESHREGISTRY_H__
+#define MESHREGISTRY_H__
+
+#include <ngl/Types.h>
+#include <ngl/AbstractVAO.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshRegistry.h
+/// @brief owns the VAOs for the scene geometry so every user of a shape shares one set of GPU buffers. Meshes are looked
+/// up by name first, so a known shape is never rebuilt, and then by a hash of their contents, so two names for the same
+/// data still end up sharing one upload. A hash match is only shared once the contents compare equal, a collision gets
+/// its own upload.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one interleaved vertex, position then normal
+//----------------------------------------------------------------------------------------------------------------------
+struct MeshVertex
+{
+  float m_position[3];
+  float m_normal[3];
+};
+
+static_assert(sizeof(MeshVertex)==6*sizeof(float),"MeshVertex is uploaded as six tightly packed floats");
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief indexed triangle list geometry as built on the CPU
+//----------------------------------------------------------------------------------------------------------------------
+struct MeshData
+{
+  std::vector<MeshVertex> m_vertices;
+  std::vector<GLushort> m_indices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MeshRegistry
+//----------------------------------------------------------------------------------------------------------------------
+class MeshRegistry
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an uploaded mesh, positions on attribute 0 and normals on attribute 2 as the Phong shader expects, the
+    /// indices are GL_UNSIGNED_SHORT and recorded in the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Mesh
+    {
+      std::unique_ptr<ngl::AbstractVAO> m_vao;
+      GLsizei m_indexCount;
+      uint64_t m_hash;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief the uploaded contents, kept to tell a mesh with the same hash from the same mesh
+      //----------------------------------------------------------------------------------------------------------------------
+      MeshData m_data;
+      //----------------------------------------------------------------------------------------------------------------------
+      /// @brief small and dense, in upload order, for packing into draw sort keys (DrawQueue)
+      //----------------------------------------------------------------------------------------------------------------------
+      uint32_t m_id;
+    };
+
+    MeshRegistry()=default;
+    ~MeshRegistry();
+    MeshRegistry(const MeshRegistry &)=delete;
+    MeshRegistry &operator=(const MeshRegistry &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief get the mesh called _name, building and uploading it with _build the first time, needs a current context
+    /// @param [in] _name the key the mesh is shared under
+    /// @param [in] _build only called when _name is not registered yet
+    /// @returns the shared mesh, valid until clear, or nullptr (and nothing registered) if _build gave no vertices or
+    /// no indices
+    //----------------------------------------------------------------------------------------------------------------------
+    const Mesh *acquire(const std::string &_name, const std::function<MeshData()> &_build);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mesh registered as _name or nullptr
+    //----------------------------------------------------------------------------------------------------------------------
+    const Mesh *find(const std::string &_name) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mesh whose m_id is _id
+    //----------------------------------------------------------------------------------------------------------------------
+    const Mesh &mesh(uint32_t _id) const { return *m_byId[_id]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of distinct meshes uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t size() const { return m_byHash.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief release every VAO, needs a current context
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief 64 bit FNV-1a of the vertices and indices
+    //----------------------------------------------------------------------------------------------------------------------
+    static uint64_t hash(const MeshData &_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true when _a and _b hold the same vertices and indices, byte for byte as hash sees them
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool sameContents(const MeshData &_a, const MeshData &_b);
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a multimap so meshes whose hashes collide can both be kept
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unordered_multimap<uint64_t,std::unique_ptr<Mesh>> m_byHash;
+    std::unordered_map<std::string,Mesh *> m_byName;
+    std::vector<Mesh *> m_byId;
+};
+
+#endif
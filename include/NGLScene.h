@@ -5,11 +5,29 @@
 #include <ngl/Light.h>
 #include <ngl/Text.h>
 
-#include <QTime>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <ngl/Transformation.h>
 
 #include <QOpenGLWindow>
 #include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "InstanceData.h"
+#include "GPUAligner.h"
+#include "UniformBlockBuffer.h"
+#include "FrameScheduler.h"
+#include "FrameProfiler.h"
+#include "MeshRegistry.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderCompileQueue.h"
+#include "InputLog.h"
+#include "Animation.h"
+#include "JobSystem.h"
+#include "TransformStore.h"
+#include "DrawQueue.h"
+#include "StreamingBuffer.h"
 
 
 #include <ngl/AbstractVAO.h>
@@ -30,9 +48,6 @@
 class NGLScene : public QOpenGLWindow
 {
   public:
-
-    void toEuler(double x,double y,double z,double angle, double &heading, double &attitude, double &bank);
-
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief ctor for our NGL drawing class
     /// @param [in] parent the parent window to the class
@@ -55,6 +70,32 @@ class NGLScene : public QOpenGLWindow
     /// @brief this is called everytime we resize
     //----------------------------------------------------------------------------------------------------------------------
     void resizeGL(int _w, int _h);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief wait for the shader programs still compiling in the background (headless runs time the real shaders)
+    //----------------------------------------------------------------------------------------------------------------------
+    void finishLoading();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame timings
+    //----------------------------------------------------------------------------------------------------------------------
+    const FrameProfiler &profiler() const { return m_profiler; }
+    void setHUDVisible(bool _visible) { m_showHUD=_visible; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the animation by exactly _steps each frame instead of by the clock, 0 goes back to the clock
+    //----------------------------------------------------------------------------------------------------------------------
+    void setFixedStepsPerFrame(int _steps) { m_scheduler.setFixedSteps(_steps); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record the input and simulation steps of every frame to _path (see InputLog.h)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool recordInput(const std::string &_path);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drive the scene from a recording made with recordInput instead of the clock and live input, frames are
+    /// then drawn back to back with no waiting
+    //----------------------------------------------------------------------------------------------------------------------
+    bool replayInput(const std::string &_path);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true once every frame of the replayed recording has been drawn
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isReplayFinished() const;
 private:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief used to store the x rotation mouse value
@@ -97,7 +138,7 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     ngl::Vec3 m_modelPos;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief used to store the global mouse transforms
+    /// @brief used to store the global mouse transforms, the root transform of m_transforms
     //----------------------------------------------------------------------------------------------------------------------
     ngl::Mat4 m_mouseGlobalTX;
     //----------------------------------------------------------------------------------------------------------------------
@@ -105,12 +146,14 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
 //    ngl::VertexArrayObject *m_vao;
 
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief shared geometry, m_vao and m_vao2 point into it
+    //----------------------------------------------------------------------------------------------------------------------
+    MeshRegistry m_meshes;
     //std::unique_ptr<ngl::VertexArrayObject> m_vao;
-    std::unique_ptr<ngl::AbstractVAO> m_vao;
+    ngl::AbstractVAO *m_vao;
     //std::unique_ptr<ngl::VertexArrayObject> m_vao2;
-    std::unique_ptr<ngl::AbstractVAO> m_vao2;
-
-    ngl::Transformation m_transform;
+    ngl::AbstractVAO *m_vao2;
 
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief Qt Event called when the window is re-sized
@@ -147,8 +190,24 @@ private:
     /// @param _event the Qt Event structure
     //----------------------------------------------------------------------------------------------------------------------
     void wheelEvent( QWheelEvent *_event);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record a live input event and apply it, dropped while a recording is replayed
+    //----------------------------------------------------------------------------------------------------------------------
+    void handleInput(InputEventType _type, int _button, int _x, int _y);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the scene side of the mouse, wheel and key handlers, shared by live input and replay
+    //----------------------------------------------------------------------------------------------------------------------
+    void applyInput(const InputEvent &_event);
 
-    void timerEvent( QTimerEvent *_event );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advance the demo animation by one fixed step of m_scheduler
+    //----------------------------------------------------------------------------------------------------------------------
+    void stepSimulation();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called once a frame has been swapped, arms m_stepTimer to request the next redraw when the next
+    /// simulation step is due, nothing is scheduled while paused
+    //----------------------------------------------------------------------------------------------------------------------
+    void scheduleNextFrame();
 
 
     //----------------------------------------------------------------------------------------------------------------------
@@ -156,18 +215,266 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     void buildVAO();
     void buildVAO2();
-
-    void toEuler(double x,double y,double z,double angle) ;
-    ngl::Vec3 eulerAngles;
-    ngl::Mat4 matrixFromAxisAngle(ngl::Vec3 axis, float angle) ;
-
-    ngl::Mat4 deriveRotMatrixToRotateV2toV1(ngl::Vec3 start, ngl::Vec3  dest);
-
-    ngl::Quaternion RotationBetweenVectors(ngl::Vec3 start, ngl::Vec3  dest);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the ShaderLib program _name, loaded from m_programCache when possible else submitted to
+    /// m_compileQueue and cached once linked, programReady is called when it can be used
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildProgram(const std::string &_name, const std::string &_vertexPath, const std::string &_fragmentPath);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a program has linked, for Phong set up its block bindings, uniform locations and light
+    //----------------------------------------------------------------------------------------------------------------------
+    void programReady(const std::string &_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief linked program binaries from earlier runs
+    //----------------------------------------------------------------------------------------------------------------------
+    ProgramBinaryCache m_programCache;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief background compiles of the programs that missed the cache
+    //----------------------------------------------------------------------------------------------------------------------
+    ShaderCompileQueue m_compileQueue;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false while Phong is compiling, the scene is then drawn with the Fallback program
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_phongReady;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief lay out the instanced cubes on a grid and attach the per instance buffer to m_vao
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildInstances();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief align every instance so it rotates its position vector onto _target (as the demo cube does with v2 / v1),
+    /// the rotations are kept in m_transforms
+    /// @param [in] _target the vector to align to
+    //----------------------------------------------------------------------------------------------------------------------
+    void alignInstances(const ngl::Vec3 &_target);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write the visible instances, as m_transforms holds them, into the next region of m_instanceStream
+    //----------------------------------------------------------------------------------------------------------------------
+    void packInstances();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the MeshRegistry id of the cube held by m_vao, every object draws it
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t m_cubeMesh;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief toggle with the I key to draw the instanced cubes as well as the demo pair
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_drawInstanced;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief point m_vao's per instance attributes (divisor 1) at the InstanceData starting at _offset in _buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    void attachInstances(GLuint _buffer, GLintptr _offset);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief per instance vertex buffer (InstanceData) the GPU aligner writes
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_instanceBuffer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief per frame InstanceData regions packInstances packs the visible instances straight into
+    //----------------------------------------------------------------------------------------------------------------------
+    StreamingBuffer m_instanceStream;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instances' starting layout, what m_instanceBuffer is created with
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<InstanceData> m_instances;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the target xyz (structure-of-arrays) handed to the batch rotation kernel, the start vectors are the
+    /// instance positions and the quaternions are written straight into m_transforms
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<float> m_instanceAlignment;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one worker per hardware thread, alignInstances, packInstances and the animation sampling split their objects over it
+    //----------------------------------------------------------------------------------------------------------------------
+    rmath::JobSystem m_jobs;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief compute shader version of alignInstances and packInstances, used instead when m_alignOnGPU is set (C key),
+    /// it packs the same visible instances
+    //----------------------------------------------------------------------------------------------------------------------
+    GPUAligner m_gpuAligner;
+    bool m_alignOnGPU;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the objects drawn with their own TransformData block, each keeps the same slot in m_transformBlocks
+    //----------------------------------------------------------------------------------------------------------------------
+    enum SceneObject
+    {
+      BOX_OBJECT=0,
+      TRIANGLE_OBJECT,
+      INSTANCES_OBJECT,
+      OBJECT_COUNT
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief compute MV, MVP and the normal matrix for the model matrix _M and stage them in _object's slot
+    //----------------------------------------------------------------------------------------------------------------------
+    void setTransform(SceneObject _object, const ngl::Mat4 &_M);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rebuild the object matrices and the alignment target from m_animation at m_animationStep
+    //----------------------------------------------------------------------------------------------------------------------
+    void updateAnimation();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief key the demo motion into m_animation
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildAnimation();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief position tracks for the cube and the triangle
+    //----------------------------------------------------------------------------------------------------------------------
+    rmath::AnimationSet m_animation;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief simulation steps taken, the time m_animation is sampled at
+    //----------------------------------------------------------------------------------------------------------------------
+    int m_animationStep;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the position, rotation and scale of every object (the scene objects then the instances), updateAnimation
+    /// and alignInstances write them, m_mouseGlobalTX is the root
+    //----------------------------------------------------------------------------------------------------------------------
+    rmath::TransformStore m_transforms;
+    rmath::TransformHandle m_objectTransform[OBJECT_COUNT];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instances are created together and never destroyed so they are m_instances.size() transforms from
+    /// this index, in m_instances order
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_firstInstance;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief test every transform's bounding sphere against the camera frustum, fills m_visible, m_objectVisible and
+    /// m_firstVisibleInstance
+    //----------------------------------------------------------------------------------------------------------------------
+    void cullObjects();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the store indices that passed the last cull, ascending, m_visibleCount of them
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint32_t> m_visible;
+    size_t m_visibleCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instances come after the scene objects in the store so the visible ones are m_visible from here on
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_firstVisibleInstance;
+    bool m_objectVisible[OBJECT_COUNT];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief instances in the instance buffer, the visible ones when aligned on the CPU, all of them from the GPU aligner
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_instanceDrawCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the program ids packed into m_drawQueue keys, the instanced variant is Phong with its instanced flag set
+    //----------------------------------------------------------------------------------------------------------------------
+    enum DrawProgram
+    {
+      FALLBACK_PROGRAM=0,
+      PHONG_PROGRAM,
+      PHONG_INSTANCED_PROGRAM
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the visible objects' draws, refilled, sorted and submitted every frame
+    //----------------------------------------------------------------------------------------------------------------------
+    DrawQueue m_drawQueue;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GL side of m_drawQueue's state changes and draws
+    //----------------------------------------------------------------------------------------------------------------------
+    DrawQueue::Backend m_drawBackend;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief distance of the object's origin in front of the camera, the depth in its sort key
+    //----------------------------------------------------------------------------------------------------------------------
+    float viewDepth(SceneObject _object) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the object's TransformData block is out of date
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_objectDirty[OBJECT_COUNT];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the camera's view and view * projection, cached while m_cameraDirty is clear
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Mat4 m_view;
+    ngl::Mat4 m_viewProject;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the camera shape has changed (resize), every block needs rebuilding
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_cameraDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief spin or model position changed, m_mouseGlobalTX and every object need rebuilding
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_mouseTXDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the simulation has stepped, updateAnimation needs calling
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_animationDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief m_alignTarget or the way the instances are aligned changed, every instance needs realigning
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_alignmentDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the visible set changed (or the last write failed), the aligned instances only need packing again
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_repackDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the camera, the root or an object has moved since the last cullObjects
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_cullDirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief v1 of the demo, the cube position the triangle and the instances align to
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 m_alignTarget;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uniform buffer for the FrameData block (camera), rewritten when the camera changes
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformBlockBuffer m_frameBlocks;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uniform buffer for the TransformData blocks, one per SceneObject
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformBlockBuffer m_transformBlocks;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief location of the Phong instanced flag, resolved once in initializeGL
+    //----------------------------------------------------------------------------------------------------------------------
+    GLint m_instancedLocation;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief upload every material the scene uses to the MaterialData block, done once in initializeGL
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildMaterials();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief select one of the materials uploaded by buildMaterials for the following draws
+    //----------------------------------------------------------------------------------------------------------------------
+    void useMaterial(GLint _index);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uniform buffer holding the material table as a single block
+    //----------------------------------------------------------------------------------------------------------------------
+    UniformBlockBuffer m_materialBlocks;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief location of the Phong materialIndex uniform
+    //----------------------------------------------------------------------------------------------------------------------
+    GLint m_materialIndexLocation;
 
 
-    int m_sphereUpdateTimer;
-    QTime currentTime;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fixed timestep for the animation, paused with the P key
+    //----------------------------------------------------------------------------------------------------------------------
+    FrameScheduler m_scheduler;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief single shot timer that requests a redraw when the next step is due
+    //----------------------------------------------------------------------------------------------------------------------
+    QTimer m_stepTimer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief count of frames drawn, tags the trace events
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t m_frameNumber;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw the FrameProfiler stats with m_text
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawHUD();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief CPU section and GPU frame timings, T writes them to frametimes.csv
+    //----------------------------------------------------------------------------------------------------------------------
+    FrameProfiler m_profiler;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief text renderer for the timing overlay, toggled with H
+    //----------------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<ngl::Text> m_text;
+    bool m_showHUD;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief --record / --replay input, see InputLog.h
+    //----------------------------------------------------------------------------------------------------------------------
+    InputRecorder m_inputRecorder;
+    InputReplayer m_inputReplayer;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief started on the first replayed frame, reported when the replay ends
+    //----------------------------------------------------------------------------------------------------------------------
+    QElapsedTimer m_replayClock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief print the replay wall time and frame timings
+    //----------------------------------------------------------------------------------------------------------------------
+    void reportReplay();
 
 };
 
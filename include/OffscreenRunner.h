@@ -0,0 +1,46 @@
+#ifndef OFFSCREENRUNNER_H__
+#define OFFSCREENRUNNER_H__
+
+#include <QSurfaceFormat>
+#include <QString>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file OffscreenRunner.h
+/// @brief headless benchmark mode. Draws the NGLScene into a framebuffer object on a QOffscreenSurface for a fixed
+/// number of frames with no window and no vsync, prints the frame timings and can save the last frame as an image.
+/// The animation is stepped once per frame rather than by the clock so every run draws the same frames, which makes
+/// it usable for automated performance runs (run with -platform offscreen on a machine with no display, llvmpipe is
+/// fine).
+/// @class OffscreenRunner
+//----------------------------------------------------------------------------------------------------------------------
+class OffscreenRunner
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor
+    /// @param [in] _format the context format, the same one the window would use
+    /// @param [in] _width framebuffer width
+    /// @param [in] _height framebuffer height
+    //----------------------------------------------------------------------------------------------------------------------
+    OffscreenRunner(const QSurfaceFormat &_format, int _width, int _height);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drive the scene from an input recording (see InputLog.h) instead of one step a frame, empty for none
+    //----------------------------------------------------------------------------------------------------------------------
+    void setReplay(const QString &_path) { m_replayPath=_path; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _frames frames and print the timings to stdout
+    /// @param [in] _frames the number of timed frames, shader compiles are waited for before the first one. 0 with a
+    /// replay draws every frame of the recording
+    /// @param [in] _imagePath if not empty the last frame is written here (format from the extension)
+    /// @returns the process exit code, non zero if the context could not be created or the image not written
+    //----------------------------------------------------------------------------------------------------------------------
+    int run(int _frames, const QString &_imagePath);
+
+  private:
+    QSurfaceFormat m_format;
+    int m_width;
+    int m_height;
+    QString m_replayPath;
+};
+
+#endif
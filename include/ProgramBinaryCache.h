@@ -0,0 +1,55 @@
+#ifndef PROGRAMBINARYCACHE_H__
+#define PROGRAMBINARYCACHE_H__
+
+#include <ngl/Types.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ProgramBinaryCache.h
+/// @brief on disk cache of linked GL programs (glGetProgramBinary / glProgramBinary). Entries are keyed on the shader
+/// sources and the GL vendor, renderer and version strings so an edited shader or a driver update simply misses.
+/// A binary the driver rejects is treated as a miss and the caller builds from source as usual.
+/// @class ProgramBinaryCache
+//----------------------------------------------------------------------------------------------------------------------
+class ProgramBinaryCache
+{
+  public:
+    ProgramBinaryCache();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief check the context can save / load binaries and create the cache directory, needs a current context
+    /// @param [in] _directory where the binaries live, created if needed
+    //----------------------------------------------------------------------------------------------------------------------
+    void init(const std::string &_directory);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the context supports program binaries (GL 4.1 and at least one binary format)
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isAvailable() const { return m_available; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief build the cache key for a program
+    /// @param [in] _sourcePaths every shader source file the program is built from
+    /// @returns hex SHA-1 of the sources and the driver strings, empty if a source can't be read
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string makeKey(const std::vector<std::string> &_sourcePaths) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief load the binary stored under _key into _program
+    /// @returns true if the program is now linked, false on a miss or if the driver rejected the binary
+    //----------------------------------------------------------------------------------------------------------------------
+    bool load(GLuint _program, const std::string &_key) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief save the linked _program under _key, it should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    //----------------------------------------------------------------------------------------------------------------------
+    void store(GLuint _program, const std::string &_key) const;
+
+  private:
+    std::string path(const std::string &_key) const;
+
+    std::string m_directory;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief GL_VENDOR, GL_RENDERER and GL_VERSION, part of every key
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_driver;
+    bool m_available;
+};
+
+#endif
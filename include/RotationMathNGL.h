@@ -0,0 +1,48 @@
+#ifndef ROTATIONMATHNGL_H__
+#define ROTATIONMATHNGL_H__
+
+#include "RotationMath.h"
+#include <ngl/Vec3.h>
+#include <ngl/Mat4.h>
+#include <ngl/Quaternion.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RotationMathNGL.h
+/// @brief conversions between the headless rmath types and their ngl equivalents, only used by the demo so the
+/// rotationmath library never has to see NGL
+//----------------------------------------------------------------------------------------------------------------------
+
+inline rmath::Vec3 toRMath(const ngl::Vec3 &_v)
+{
+  return rmath::Vec3(_v.m_x,_v.m_y,_v.m_z);
+}
+
+inline ngl::Vec3 toNGL(const rmath::Vec3 &_v)
+{
+  return ngl::Vec3(_v.m_x,_v.m_y,_v.m_z);
+}
+
+inline ngl::Quaternion toNGL(const rmath::Quaternion &_q)
+{
+  return ngl::Quaternion(_q.m_s,_q.m_x,_q.m_y,_q.m_z);
+}
+
+inline rmath::Mat4 toRMath(const ngl::Mat4 &_m)
+{
+  rmath::Mat4 m;
+  for(int r=0; r<4; ++r)
+    for(int c=0; c<4; ++c)
+      m.m_m[r][c]=_m.m_m[r][c];
+  return m;
+}
+
+inline ngl::Mat4 toNGL(const rmath::Mat4 &_m)
+{
+  ngl::Mat4 m;
+  for(int r=0; r<4; ++r)
+    for(int c=0; c<4; ++c)
+      m.m_m[r][c]=_m.m_m[r][c];
+  return m;
+}
+
+#endif
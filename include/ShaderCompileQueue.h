@@ -0,0 +1,74 @@
+#ifndef SHADERCOMPILEQUEUE_H__
+#define SHADERCOMPILEQUEUE_H__
+
+#include <ngl/Types.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ShaderCompileQueue.h
+/// @brief submits every shader compile and program link up front and reports them finished later, so the first frame
+/// never waits on the driver compiler. With KHR_parallel_shader_compile (or the ARB version) the driver compiles on
+/// its own threads and completion is polled with GL_COMPLETION_STATUS_KHR. Without it, poll finishes at most one program
+/// per call so the wait is spread over several frames.
+/// @class ShaderCompileQueue
+//----------------------------------------------------------------------------------------------------------------------
+class ShaderCompileQueue
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called once a program has finished linking
+    /// @param [in] _program the program id passed to submit
+    /// @param [in] _linked false if a stage failed to compile or the link failed, the log has already been printed
+    //----------------------------------------------------------------------------------------------------------------------
+    typedef std::function<void(GLuint _program, bool _linked)> Callback;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one shader stage of a program
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Stage
+    {
+      GLenum m_type;
+      std::string m_path;
+    };
+
+    ShaderCompileQueue();
+    ~ShaderCompileQueue();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief look for the parallel compile extension and let the driver use all its threads, needs a current context
+    //----------------------------------------------------------------------------------------------------------------------
+    void init();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief compile _stages and link them into _program without waiting for the result
+    /// @param [in] _name used in error messages
+    /// @param [in] _program an existing, empty program object
+    /// @param [in] _stages the sources to compile and attach
+    /// @param [in] _done called from poll once the program has linked (or failed)
+    //----------------------------------------------------------------------------------------------------------------------
+    void submit(const std::string &_name, GLuint _program, const std::vector<Stage> &_stages, Callback _done);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finish whatever has completed, calling the callbacks
+    /// @returns true while programs are still pending
+    //----------------------------------------------------------------------------------------------------------------------
+    bool poll();
+    bool isPending() const { return !m_jobs.empty(); }
+    bool hasParallelCompile() const { return m_parallel; }
+
+  private:
+    struct Job
+    {
+      std::string m_name;
+      GLuint m_program;
+      std::vector<GLuint> m_shaders;
+      Callback m_done;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief check the compile / link status of _job (this waits if it is not done), report and release its shaders
+    //----------------------------------------------------------------------------------------------------------------------
+    void finish(Job &_job);
+
+    std::vector<Job> m_jobs;
+    bool m_parallel;
+};
+
+#endif
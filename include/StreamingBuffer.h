@@ -0,0 +1,86 @@
+#ifndef STREAMINGBUFFER_H__
+#define STREAMINGBUFFER_H__
+
+#include <ngl/Types.h>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file StreamingBuffer.h
+/// @brief a buffer the CPU rewrites every frame without the driver copying the data or stalling on draws still
+/// reading it. On GL 4.4 the storage is immutable (glBufferStorage) and mapped once, persistent and coherent, and is
+/// split into REGION_COUNT regions used in turn : while the GPU reads the region written last frame the CPU fills the
+/// next, and a fence placed after the draws that read a region is waited on before that region is written again.
+/// Older contexts map a single region with GL_MAP_INVALIDATE_BUFFER_BIT each frame so the driver orphans it instead.
+/// Either way the caller writes straight into the pointer beginWrite returns.
+/// @class StreamingBuffer
+//----------------------------------------------------------------------------------------------------------------------
+class StreamingBuffer
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief regions of the persistent buffer, one being written, up to two still queued for the GPU
+    //----------------------------------------------------------------------------------------------------------------------
+    static const int REGION_COUNT=3;
+
+    StreamingBuffer();
+    ~StreamingBuffer();
+    StreamingBuffer(const StreamingBuffer &)=delete;
+    StreamingBuffer &operator=(const StreamingBuffer &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the buffer, needs a current context. If the persistent storage or its mapping fails the
+    /// fallback is used instead
+    /// @param [in] _target the binding point the fallback maps through (GL_ARRAY_BUFFER for vertex data)
+    /// @param [in] _regionSize the most bytes written in one frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void init(GLenum _target, size_t _regionSize);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move on to the next region, waiting for the GPU to finish with it if it has not
+    /// @returns where to write up to regionSize bytes, valid until endWrite, nullptr if the fallback could not map
+    /// the buffer, in which case endWrite must not be called and nothing should be drawn from it
+    //----------------------------------------------------------------------------------------------------------------------
+    void *beginWrite();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finish a write that beginWrite started
+    /// @returns false if the fallback's data was lost while mapped, the region should not be drawn from
+    //----------------------------------------------------------------------------------------------------------------------
+    bool endWrite();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief call after the draws that read the current region have been issued
+    //----------------------------------------------------------------------------------------------------------------------
+    void fence();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GL buffer id and where the current region starts in it
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint id() const { return m_id; }
+    GLintptr offset() const { return static_cast<GLintptr>(m_region*m_regionSize); }
+    size_t regionSize() const { return m_regionSize; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false when running the pre 4.4 fallback
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isPersistent() const { return m_persistent; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many beginWrite calls had to wait on a fence, the GPU is more than REGION_COUNT-1 frames behind
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t stalls() const { return m_stalls; }
+
+  private:
+    GLuint m_id;
+    GLenum m_target;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the requested size rounded up so every region starts suitably aligned for any binding
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_regionSize;
+    bool m_persistent;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the whole persistent mapping, nullptr for the fallback
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned char *m_mapped;
+    int m_region;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the fence after the last draws reading each region, nullptr once waited on
+    //----------------------------------------------------------------------------------------------------------------------
+    GLsync m_fences[REGION_COUNT];
+    size_t m_stalls;
+};
+
+#endif
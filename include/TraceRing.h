@@ -0,0 +1,119 @@
+#ifndef TRACERING_H__
+#define TRACERING_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TraceRing.h
+/// @brief fixed size binary trace records and the single producer / single consumer ring they travel through from the
+/// render thread to the Tracer drain thread. Storage is allocated once at construction, push and pop never lock,
+/// allocate or block, a push into a full ring drops the record and counts it.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief what a TraceEvent records and how its m_data is laid out
+//----------------------------------------------------------------------------------------------------------------------
+enum class TraceEventType : uint16_t
+{
+  FRAMEBEGIN=0,     ///< no data
+  FRAMEEND,         ///< no data
+  ANGLE,            ///< m_data[0] the demo swing angle in degrees
+  ROTATIONFROM,     ///< m_data[0..2] the vector rotated from
+  ROTATIONTO,       ///< m_data[0..2] the vector rotated to
+  ROTATIONRESULT,   ///< m_data[0..3] the quaternion s x y z
+  BUFFERUPLOAD      ///< m_data[0] bytes uploaded, m_data[1] element count
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one 32 byte trace record, written to the trace file as is
+//----------------------------------------------------------------------------------------------------------------------
+struct TraceEvent
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief steady clock nanoseconds since the Tracer started
+  //----------------------------------------------------------------------------------------------------------------------
+  uint64_t m_timeNs;
+  uint32_t m_frame;
+  TraceEventType m_type;
+  uint16_t m_pad;
+  float m_data[4];
+};
+
+static_assert(sizeof(TraceEvent)==32,"TraceEvent is written to the trace file as a 32 byte record");
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TraceRing
+/// @brief lock free SPSC queue of TraceEvent, capacity is rounded up to a power of two
+//----------------------------------------------------------------------------------------------------------------------
+class TraceRing
+{
+  public:
+    explicit TraceRing(size_t _capacity)
+    {
+      size_t capacity=1;
+      while(capacity<_capacity)
+      {
+        capacity<<=1;
+      }
+      m_events.resize(capacity);
+      m_mask=capacity-1;
+      m_head.store(0,std::memory_order_relaxed);
+      m_tail.store(0,std::memory_order_relaxed);
+      m_dropped.store(0,std::memory_order_relaxed);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief producer side, copy _event in or drop it if the consumer has fallen a full ring behind
+    /// @returns false if the event was dropped
+    //----------------------------------------------------------------------------------------------------------------------
+    bool push(const TraceEvent &_event)
+    {
+      size_t head=m_head.load(std::memory_order_relaxed);
+      if(head-m_tail.load(std::memory_order_acquire)>m_mask)
+      {
+        m_dropped.fetch_add(1,std::memory_order_relaxed);
+        return false;
+      }
+      m_events[head&m_mask]=_event;
+      m_head.store(head+1,std::memory_order_release);
+      return true;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief consumer side, copy up to _max events into o_events
+    /// @returns the number of events copied
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t pop(TraceEvent *o_events, size_t _max)
+    {
+      size_t tail=m_tail.load(std::memory_order_relaxed);
+      size_t available=m_head.load(std::memory_order_acquire)-tail;
+      size_t count=available<_max ? available : _max;
+      for(size_t i=0; i<count; ++i)
+      {
+        o_events[i]=m_events[(tail+i)&m_mask];
+      }
+      m_tail.store(tail+count,std::memory_order_release);
+      return count;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of events dropped because the ring was full
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    size_t capacity() const { return m_mask+1; }
+
+  private:
+    std::vector<TraceEvent> m_events;
+    size_t m_mask;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief write position, only stored by the producer; kept on its own cache line from the read position
+    //----------------------------------------------------------------------------------------------------------------------
+    alignas(64) std::atomic<size_t> m_head;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief read position, only stored by the consumer
+    //----------------------------------------------------------------------------------------------------------------------
+    alignas(64) std::atomic<size_t> m_tail;
+    alignas(64) std::atomic<uint64_t> m_dropped;
+};
+
+#endif
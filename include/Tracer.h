@@ -0,0 +1,80 @@
+#ifndef TRACER_H__
+#define TRACER_H__
+
+#include "TraceRing.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Tracer.h
+/// @brief binary event tracing for the render thread. Events go into a preallocated TraceRing and a background thread
+/// drains it to a file, so tracing a frame never allocates, locks or waits on stdout.
+/// The file is an 8 byte header ("RTRC", uint32 version 1) followed by TraceEvent records.
+/// @class Tracer
+//----------------------------------------------------------------------------------------------------------------------
+class Tracer
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the process wide tracer, disabled until start is called
+    //----------------------------------------------------------------------------------------------------------------------
+    static Tracer &instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief open _path and start the drain thread
+    /// @returns false if the file can't be opened, tracing then stays disabled
+    //----------------------------------------------------------------------------------------------------------------------
+    bool start(const std::string &_path);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drain everything left in the ring, stop the thread and close the file
+    //----------------------------------------------------------------------------------------------------------------------
+    void stop();
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief record an event, a no-op when tracing is off, only call from one thread (the render thread)
+    //----------------------------------------------------------------------------------------------------------------------
+    void record(TraceEventType _type, uint32_t _frame, float _a=0.0f, float _b=0.0f, float _c=0.0f, float _d=0.0f)
+    {
+      if(!isEnabled())
+      {
+        return;
+      }
+      TraceEvent event;
+      event.m_timeNs=static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now()-m_startTime).count());
+      event.m_frame=_frame;
+      event.m_type=_type;
+      event.m_pad=0;
+      event.m_data[0]=_a;
+      event.m_data[1]=_b;
+      event.m_data[2]=_c;
+      event.m_data[3]=_d;
+      m_ring.push(event);
+    }
+
+  private:
+    Tracer();
+    ~Tracer();
+    Tracer(const Tracer &)=delete;
+    Tracer &operator=(const Tracer &)=delete;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief body of the drain thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void drain();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief move whatever is in the ring to the file
+    /// @returns the number of events written
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t flush();
+
+    TraceRing m_ring;
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    std::FILE *m_file;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+#endif
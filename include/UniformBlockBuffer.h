@@ -0,0 +1,140 @@
+#ifndef UNIFORMBLOCKBUFFER_H__
+#define UNIFORMBLOCKBUFFER_H__
+
+#include <ngl/Types.h>
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <ngl/Vec3.h>
+#include <ngl/Material.h>
+#include <cstddef>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBlockBuffer.h
+/// @brief std140 uniform blocks shared with PhongVertex.glsl and a buffer that holds many of them at the
+/// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT stride, so every block for a frame is uploaded with one call and each draw
+/// only has to bind its range.
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief binding points used by the blocks below
+//----------------------------------------------------------------------------------------------------------------------
+const static GLuint FRAME_BLOCK_BINDING=0;
+const static GLuint TRANSFORM_BLOCK_BINDING=1;
+const static GLuint MATERIAL_BLOCK_BINDING=2;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief size of the materials array in PhongFragment.glsl
+//----------------------------------------------------------------------------------------------------------------------
+const static int MAX_MATERIALS=8;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief per frame camera data, uniform FrameData in the shaders
+//----------------------------------------------------------------------------------------------------------------------
+struct FrameBlock
+{
+  GLfloat m_V[16];
+  GLfloat m_VP[16];
+  GLfloat m_viewerPos[4];
+
+  void set(const ngl::Mat4 &_V, const ngl::Mat4 &_VP, const ngl::Vec3 &_eye);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief per object transforms, uniform TransformData in the shaders
+/// the ngl matrices are stored as they are handed to glUniformMatrix*fv, std140 pads each mat3 column to a vec4
+//----------------------------------------------------------------------------------------------------------------------
+struct TransformBlock
+{
+  GLfloat m_M[16];
+  GLfloat m_MV[16];
+  GLfloat m_MVP[16];
+  GLfloat m_normalMatrix[12];
+
+  void set(const ngl::Mat4 &_M, const ngl::Mat4 &_MV, const ngl::Mat4 &_MVP, const ngl::Mat3 &_normalMatrix);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one entry of the materials array in the MaterialData block, same members as ngl::Material loads
+//----------------------------------------------------------------------------------------------------------------------
+struct MaterialBlock
+{
+  GLfloat m_ambient[4];
+  GLfloat m_diffuse[4];
+  GLfloat m_specular[4];
+  GLfloat m_shininess;
+  GLfloat m_pad[3];
+
+  void set(const ngl::Material &_material);
+};
+
+static_assert(sizeof(MaterialBlock)==64,"MaterialBlock must match the std140 array stride of Materials");
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBlockBuffer
+/// @brief a GL uniform buffer of equally sized blocks, filled on the CPU with push (or set for blocks kept in fixed
+/// slots across frames) then sent with one upload, which is skipped when nothing has been written since the last one
+//----------------------------------------------------------------------------------------------------------------------
+class UniformBlockBuffer
+{
+  public:
+    UniformBlockBuffer();
+    ~UniformBlockBuffer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief create the buffer, needs a current context
+    /// @param [in] _binding the uniform buffer binding point the blocks are bound to
+    /// @param [in] _blockSize sizeof the block structure
+    /// @param [in] _capacity initial number of blocks, grows as needed
+    //----------------------------------------------------------------------------------------------------------------------
+    void init(GLuint _binding, size_t _blockSize, size_t _capacity);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief forget the blocks pushed so far, call at the start of a frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear() { m_count=0; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy a block into the staging area
+    /// @returns the slot to pass to bind once uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t push(const void *_block);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief overwrite the block in _slot, growing the count to include it, for buffers whose blocks are not
+    /// rebuilt every frame
+    //----------------------------------------------------------------------------------------------------------------------
+    void set(size_t _slot, const void *_block);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief send every block to the GPU (orphaning the previous storage), a no-op if none has changed
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bind the range of _slot to our binding point
+    //----------------------------------------------------------------------------------------------------------------------
+    void bind(size_t _slot) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bytes between consecutive blocks
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t stride() const { return m_stride; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the GL buffer id
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint id() const { return m_id; }
+
+  private:
+    GLuint m_id;
+    GLuint m_binding;
+    size_t m_blockSize;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief m_blockSize rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_stride;
+    size_t m_count;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a block has been written since the last upload
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_dirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of blocks the GL buffer currently has room for
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_gpuCapacity;
+    std::vector<unsigned char> m_staging;
+};
+
+#endif
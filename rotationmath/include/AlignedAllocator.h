@@ -0,0 +1,56 @@
+#ifndef ALIGNEDALLOCATOR_H__
+#define ALIGNEDALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AlignedAllocator.h
+/// @brief a std::vector allocator that starts every array on an Alignment byte boundary (a cache line by default)
+/// so SIMD blocks of a structure-of-arrays stream never straddle two lines at the start
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+template<typename T, size_t Alignment=64>
+class AlignedAllocator
+{
+  public:
+    typedef T value_type;
+    template<typename U> struct rebind { typedef AlignedAllocator<U,Alignment> other; };
+
+    AlignedAllocator()=default;
+    template<typename U> AlignedAllocator(const AlignedAllocator<U,Alignment> &) {}
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief over allocate by Alignment and keep the block ::operator new returned just before the aligned pointer
+    //----------------------------------------------------------------------------------------------------------------------
+    T *allocate(size_t _count)
+    {
+      void *block=::operator new(_count*sizeof(T)+Alignment+sizeof(void *));
+      uintptr_t first=reinterpret_cast<uintptr_t>(block)+sizeof(void *);
+      uintptr_t aligned=(first+Alignment-1) & ~static_cast<uintptr_t>(Alignment-1);
+      reinterpret_cast<void **>(aligned)[-1]=block;
+      return reinterpret_cast<T *>(aligned);
+    }
+
+    void deallocate(T *_p, size_t)
+    {
+      ::operator delete(reinterpret_cast<void **>(_p)[-1]);
+    }
+
+    template<typename U> bool operator==(const AlignedAllocator<U,Alignment> &) const { return true; }
+    template<typename U> bool operator!=(const AlignedAllocator<U,Alignment> &) const { return false; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a cache line aligned array of floats, the component type of the structure-of-arrays stores
+//----------------------------------------------------------------------------------------------------------------------
+typedef std::vector<float,AlignedAllocator<float>> AlignedFloats;
+
+} // end namespace rmath
+
+#endif
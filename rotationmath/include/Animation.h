@@ -0,0 +1,141 @@
+#ifndef ANIMATION_H__
+#define ANIMATION_H__
+
+#include "JobSystem.h"
+#include "RotationBatch.h"
+#include "RotationMath.h"
+
+#include <cstddef>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Animation.h
+/// @brief keyframe animation of position and orientation for many objects at once. Every object has a track of
+/// position keys and a track of rotation keys, all tracks are sampled together in blocks : the bracketing keys are
+/// gathered into structure-of-arrays scratch and interpolated 8 (AVX) or 4 (SSE) tracks at a time, optionally with
+/// the tracks split over the threads of a JobSystem. Sampling costs a key search and a few multiplies per object, no trig.
+/// Rotations can be nlerped or slerped. The batched nlerp is bit identical to rmath::nlerp (with -ffp-contract=off).
+/// The batched slerp is nlerp with a polynomial correction of t (Kapoulkine's "approximating slerp") so it needs no
+/// acos / sin, its angle error against a true slerp is below 1.5e-3 radians (1.24e-3 at worst, for keys a half turn
+/// apart, rottest checks the bound), sampleReference gives the exact result.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a position at a time (in whatever unit the caller samples with)
+//----------------------------------------------------------------------------------------------------------------------
+struct PositionKey
+{
+  float m_time;
+  Vec3 m_value;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief an orientation at a time, the quaternion should be normalized
+//----------------------------------------------------------------------------------------------------------------------
+struct RotationKey
+{
+  float m_time;
+  Quaternion m_value;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief how rotation keys are blended
+//----------------------------------------------------------------------------------------------------------------------
+enum class RotationInterpolation
+{
+  NLERP,
+  SLERP
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a writable structure-of-arrays view of sampled poses, one entry per track
+//----------------------------------------------------------------------------------------------------------------------
+struct PoseStream
+{
+  float *m_x;
+  float *m_y;
+  float *m_z;
+  QuaternionStream m_rotation;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief normalized linear blend of _a and _b along the shortest arc
+//----------------------------------------------------------------------------------------------------------------------
+Quaternion nlerp(const Quaternion &_a, const Quaternion &_b, float _t);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief spherical linear blend of _a and _b along the shortest arc, evaluated in double
+//----------------------------------------------------------------------------------------------------------------------
+Quaternion slerp(const Quaternion &_a, const Quaternion &_b, float _t);
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class AnimationSet
+/// @brief the keys of every track packed into flat arrays, sampled with sample
+//----------------------------------------------------------------------------------------------------------------------
+class AnimationSet
+{
+  public:
+    AnimationSet();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add a track, times must be increasing and each list needs at least one key. Before the first and after
+    /// the last key the track holds that key
+    /// @returns the index of the track in the sampled streams
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t addTrack(const std::vector<PositionKey> &_positions, const std::vector<RotationKey> &_rotations);
+    void clear();
+    size_t trackCount() const { return m_positionRange.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the time of the last key of any track
+    //----------------------------------------------------------------------------------------------------------------------
+    float duration() const { return m_duration; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sample every track at _time into _out (trackCount entries)
+    /// @param [in] _jobs the tracks are split into chunks of whole sample blocks run on these threads, nullptr
+    /// samples on the calling thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void sample(float _time, const PoseStream &_out, RotationInterpolation _mode=RotationInterpolation::NLERP,
+                JobSystem *_jobs=nullptr) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sample tracks [_begin,_end) only, for callers that schedule the work themselves. Disjoint ranges can be
+    /// sampled concurrently
+    //----------------------------------------------------------------------------------------------------------------------
+    void sampleRange(float _time, size_t _begin, size_t _end, const PoseStream &_out, RotationInterpolation _mode) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one track at a time with the scalar nlerp / exact slerp, the baseline and reference for sample
+    //----------------------------------------------------------------------------------------------------------------------
+    void sampleReference(float _time, const PoseStream &_out, RotationInterpolation _mode) const;
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where a track's keys live in the key arrays
+    //----------------------------------------------------------------------------------------------------------------------
+    struct KeyRange
+    {
+      size_t m_first;
+      size_t m_count;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief find the keys either side of _time in _range of _times
+    /// @returns the index of the first key, o_next the second (the same key when clamped) and o_t the blend between them
+    //----------------------------------------------------------------------------------------------------------------------
+    static size_t findKey(const std::vector<float> &_times, const KeyRange &_range, float _time, size_t &o_next, float &o_t);
+
+    std::vector<KeyRange> m_positionRange;
+    std::vector<KeyRange> m_rotationRange;
+    std::vector<float> m_positionTime;
+    std::vector<float> m_positionX;
+    std::vector<float> m_positionY;
+    std::vector<float> m_positionZ;
+    std::vector<float> m_rotationTime;
+    std::vector<float> m_rotationS;
+    std::vector<float> m_rotationX;
+    std::vector<float> m_rotationY;
+    std::vector<float> m_rotationZ;
+    float m_duration;
+};
+
+} // end namespace rmath
+
+#endif
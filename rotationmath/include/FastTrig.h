@@ -0,0 +1,211 @@
+#ifndef FASTTRIG_H__
+#define FASTTRIG_H__
+
+#include <cmath>
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FastTrig.h
+/// @brief the trig used by the rotation routines at a choice of accuracy. FastTrig<TrigAccuracy::FULL> is libm,
+/// LOW and MEDIUM are branch free minimax polynomials (fitted for this file, Lawson's algorithm) :
+///   sin / cos   reduced to [-pi,pi] with a three constant Cody-Waite step then folded to [-pi/2,pi/2], x*P(x^2)
+///   atan2       atan of min/max on [0,1] as x*P(x^2) then moved to the right octant
+///   acos / asin sqrt(1-|x|)*P(|x|) (Abramowitz and Stegun 4.4.45 form), asin = pi/2 - acos
+/// Worst absolute error in float over the whole domain (|x| < 1e4 for sin / cos), scalar and array versions alike :
+///   LOW     below 1e-3 (sin / cos 7e-5, atan2 7e-4, acos / asin 4e-4), 3 term polynomials
+///   MEDIUM  below 1e-5 (sin / cos 1e-6, atan2 2e-6, acos / asin 6e-6), 4 to 6 term polynomials
+/// The polynomial kernels are templates written with operators and the select / roundNearest / absolute /
+/// squareRoot / minimum / maximum helpers so they run on float, double or a SIMD register type (the array versions run
+/// them 8 (AVX) or 4 (SSE) floats at a time). The double versions use the same float coefficients, they are no
+/// more accurate than the tier. A NaN argument gives NaN in every tier, as libm does, other arguments are expected to
+/// be finite. acos / asin clamp to [-1,1] in every tier, FULL included, so the dot of two unit vectors rounded just
+/// past 1 gives 0 or pi rather than NaN whichever tier is picked. atan2(0,0) is 0 and the sign of zero is not kept.
+/// rottest checks every tier's scalar and array functions against these bounds.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief accuracy tiers, the absolute error bound each tier is held to
+//----------------------------------------------------------------------------------------------------------------------
+enum class TrigAccuracy
+{
+  LOW,      ///< 1e-3
+  MEDIUM,   ///< 1e-5
+  FULL      ///< libm
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief scalar versions of the lane helpers the polynomial kernels are written with
+//----------------------------------------------------------------------------------------------------------------------
+inline float select(bool _m, float _a, float _b) { return _m ? _a : _b; }
+inline double select(bool _m, double _a, double _b) { return _m ? _a : _b; }
+// adding and removing 1.5*2^23 (2^52) rounds to nearest without a libm call, valid while |_a| < 2^22 (2^51)
+inline float roundNearest(float _a) { return (_a+12582912.0f)-12582912.0f; }
+inline double roundNearest(double _a) { return (_a+6755399441055744.0)-6755399441055744.0; }
+inline float absolute(float _a) { return std::fabs(_a); }
+inline double absolute(double _a) { return std::fabs(_a); }
+inline float squareRoot(float _a) { return std::sqrt(_a); }
+inline double squareRoot(double _a) { return std::sqrt(_a); }
+inline float minimum(float _a, float _b) { return _a<_b ? _a : _b; }
+inline double minimum(double _a, double _b) { return _a<_b ? _a : _b; }
+inline float maximum(float _a, float _b) { return _a>_b ? _a : _b; }
+inline double maximum(double _a, double _b) { return _a>_b ? _a : _b; }
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the type of one lane of T, T itself for float and double
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+struct LaneScalar
+{
+  typedef T type;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class FastTrig
+/// @brief the trig functions of one tier, e.g. FastTrig<TrigAccuracy::LOW>::sin(x)
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A>
+class FastTrig
+{
+  public:
+    template<typename T> static T sin(T _x)
+    {
+      return sinReduced(_x,T(0.0f),T(0.0f));
+    }
+
+    template<typename T> static T cos(T _x)
+    {
+      // cos(x) = sin(x+pi/2), the quarter turn is added after the reduction so it costs no precision
+      return sinReduced(_x,T(0.25f),T(1.57079633f));
+    }
+
+    template<typename T> static T atan2(T _y, T _x)
+    {
+      const T halfPi(1.57079633f);
+      const T pi(3.14159265f);
+      const T zero(0.0f);
+      T ax=absolute(_x);
+      T ay=absolute(_y);
+      T hi=maximum(ax,ay);
+      T lo=minimum(ax,ay);
+      // both lanes of the select are evaluated so 0/0 is computed (quietly) then replaced
+      T a=select(hi>zero,lo/hi,zero);
+      T a2=a*a;
+      T p;
+      if(A==TrigAccuracy::LOW)
+      {
+        p=T(0.995357955f)+a2*(T(-0.288690235f)+a2*T(0.0793390372f));
+      }
+      else
+      {
+        p=T(0.999977219f)+a2*(T(-0.332622828f)+a2*(T(0.193540376f)+a2*(T(-0.116426481f)+
+          a2*(T(0.0526473501f)+a2*T(-0.011719135f)))));
+      }
+      T r=a*p;
+      r=select(ay>ax,halfPi-r,r);
+      r=select(_x<zero,pi-r,r);
+      r=select(_y<zero,-r,r);
+      // min / max above drop a NaN, a NaN in either argument is put back (x==x is false only for NaN)
+      r=select(_x==_x,r,_x);
+      return select(_y==_y,r,_y);
+    }
+
+    template<typename T> static T acos(T _x)
+    {
+      const T one(1.0f);
+      T a=minimum(absolute(_x),one);
+      T p;
+      if(A==TrigAccuracy::LOW)
+      {
+        p=T(1.57047026f)+a*(T(-0.205497532f)+a*T(0.0513895216f));
+      }
+      else
+      {
+        p=T(1.57079153f)+a*(T(-0.214280611f)+a*(T(0.085638375f)+a*(T(-0.0376182117f)+a*T(0.00973296606f))));
+      }
+      T r=squareRoot(one-a)*p;
+      // acos(-x) = pi - acos(x)
+      r=select(_x<T(0.0f),T(3.14159265f)-r,r);
+      // the clamp above turns a NaN into 1, put it back
+      return select(_x==_x,r,_x);
+    }
+
+    template<typename T> static T asin(T _x)
+    {
+      return T(1.57079633f)-acos(_x);
+    }
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the array versions, _out[i]=f(_in[i]) for _count values. _out may be _in
+    //----------------------------------------------------------------------------------------------------------------------
+    static void sin(const float *_in, float *_out, size_t _count);
+    static void cos(const float *_in, float *_out, size_t _count);
+    static void atan2(const float *_y, const float *_x, float *_out, size_t _count);
+    static void acos(const float *_in, float *_out, size_t _count);
+    static void asin(const float *_in, float *_out, size_t _count);
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sin(_x+_offset) where _offset is _turns of 2pi. _x is reduced by whole turns with 2pi split in three
+    /// (Cody-Waite), the first part has 8 bits so k*6.28125 is exact and the reduction holds the tier for |_x| up to
+    /// about 1e4
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename T> static T sinReduced(T _x, T _turns, T _offset)
+    {
+      const T halfPi(1.57079633f);
+      const T pi(3.14159265f);
+      T k=roundNearest(_x*T(0.159154943f)+_turns);
+      T r=((_x-k*T(6.28125f))-k*T(0.00193530717f))-k*T(1.02531317e-11f)+_offset;
+      // sin(pi-r) = sin(r) folds [-pi,pi] to [-pi/2,pi/2]
+      r=select(r>halfPi,pi-r,r);
+      r=select(r<-halfPi,-pi-r,r);
+      T r2=r*r;
+      T p;
+      if(A==TrigAccuracy::LOW)
+      {
+        p=T(0.999696774f)+r2*(T(-0.16567308f)+r2*T(0.00751437739f));
+      }
+      else
+      {
+        p=T(0.999996616f)+r2*(T(-0.166648284f)+r2*(T(0.00830632524f)+r2*T(-0.000183636543f)));
+      }
+      return r*p;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief full precision, std:: for float and double, a SIMD register type supplies its own (found by argument
+/// dependent lookup). The array versions are plain loops over libm
+//----------------------------------------------------------------------------------------------------------------------
+template<>
+class FastTrig<TrigAccuracy::FULL>
+{
+  public:
+    template<typename T> static T sin(T _x) { using std::sin; return sin(_x); }
+    template<typename T> static T cos(T _x) { using std::cos; return cos(_x); }
+    template<typename T> static T atan2(T _y, T _x) { using std::atan2; return atan2(_y,_x); }
+    template<typename T> static T acos(T _x) { using std::acos; return acos(clampUnit(_x)); }
+    template<typename T> static T asin(T _x) { using std::asin; return asin(clampUnit(_x)); }
+
+    static void sin(const float *_in, float *_out, size_t _count);
+    static void cos(const float *_in, float *_out, size_t _count);
+    static void atan2(const float *_y, const float *_x, float *_out, size_t _count);
+    static void acos(const float *_in, float *_out, size_t _count);
+    static void asin(const float *_in, float *_out, size_t _count);
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the acos / asin domain, as the polynomial tiers clamp. Written with selects rather than minimum /
+    /// maximum so a NaN passes through
+    //----------------------------------------------------------------------------------------------------------------------
+    template<typename T> static T clampUnit(T _x)
+    {
+      return select(_x>T(1.0f),T(1.0f),select(_x<T(-1.0f),T(-1.0f),_x));
+    }
+};
+
+} // end namespace rmath
+
+#endif
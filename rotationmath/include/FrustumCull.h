@@ -0,0 +1,48 @@
+#ifndef FRUSTUMCULL_H__
+#define FRUSTUMCULL_H__
+
+#include "RotationBatch.h"
+#include "RotationMath.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file FrustumCull.h
+/// @brief bounding sphere against view frustum tests for many objects at once. The six planes are pulled out of a
+/// (model *) view * projection matrix (Gribb / Hartmann) and normalized, a sphere is kept unless it lies wholly
+/// outside one of them. cullSpheres tests 8 (AVX) or 4 (SSE) spheres at a time and writes the indices of the
+/// survivors packed and in order, with no per-sphere branches. The test is conservative : a sphere just off a
+/// corner of the frustum can pass all six planes and is kept.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the planes a*x+b*y+c*z+d, positive inside and with (a,b,c) unit length so the value is a distance
+//----------------------------------------------------------------------------------------------------------------------
+struct Frustum
+{
+  enum Plane { LEFTPLANE=0, RIGHTPLANE, BOTTOMPLANE, TOPPLANE, NEARPLANE, FARPLANE, PLANECOUNT };
+  float m_planes[PLANECOUNT][4];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the frustum of the row vector (ngl) matrix _m, in the space _m transforms from. Pass model * view *
+/// projection to test spheres given in model space, the radii are only right if model has no scale
+//----------------------------------------------------------------------------------------------------------------------
+Frustum frustumFromMatrix(const Mat4 &_m);
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief test the spheres [_begin,_end) of _centres / _radii
+/// @param [out] o_visible receives the indices of the spheres inside or crossing the frustum, ascending. It needs room
+/// for _end-_begin entries (every lane of a register is written before the count is known)
+/// @returns how many were written
+//----------------------------------------------------------------------------------------------------------------------
+size_t cullSpheres(const Frustum &_frustum, const Vec3Stream &_centres, const float *_radii, size_t _begin, size_t _end,
+                   uint32_t *o_visible);
+
+} // end namespace rmath
+
+#endif
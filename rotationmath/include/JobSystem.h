@@ -0,0 +1,98 @@
+#ifndef JOBSYSTEM_H__
+#define JOBSYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file JobSystem.h
+/// @brief a fixed pool of worker threads for splitting per-object work across cores. parallelFor cuts the index range
+/// into chunks up front and deals them out to one queue per thread, each thread works through its own queue and when
+/// it runs dry steals chunks from the other end of another thread's queue, so uneven chunks still finish together.
+/// The calling thread works too, it is the first queue. The threads live as long as the JobSystem and sleep between
+/// calls, so a parallelFor costs a wake up rather than a thread start.
+/// The queues are mutex protected deques : there are only a few chunks per thread per call so the locks are cheap
+/// next to the work, a lock free (Chase-Lev) deque would only pay off for far finer grained jobs.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class JobSystem
+/// @brief work stealing thread pool, parallelFor must only be called from one thread at a time and not from inside
+/// a kernel. Kernels must not throw
+//----------------------------------------------------------------------------------------------------------------------
+class JobSystem
+{
+  public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a kernel processes the indices [_begin,_end)
+    //----------------------------------------------------------------------------------------------------------------------
+    typedef std::function<void(size_t _begin, size_t _end)> Kernel;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief start the workers
+    /// @param [in] _threads the total number of threads working on a parallelFor including the caller, 0 for one
+    /// per hardware thread. 1 runs every kernel on the calling thread
+    //----------------------------------------------------------------------------------------------------------------------
+    explicit JobSystem(size_t _threads=0);
+    ~JobSystem();
+    JobSystem(const JobSystem &)=delete;
+    JobSystem &operator=(const JobSystem &)=delete;
+    size_t threadCount() const { return m_queues.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run _kernel over [0,_count) split into chunks and wait for all of them
+    /// @param [in] _grain chunks are whole multiples of this many indices (bar the last), so a kernel that works in
+    /// blocks or SIMD lanes can be handed aligned ranges. Ranges of a single grain run on the calling thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void parallelFor(size_t _count, size_t _grain, const Kernel &_kernel);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief chunks run by a thread other than the one they were dealt to, since construction
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t stolenChunks() const { return m_stolen.load(std::memory_order_relaxed); }
+
+  private:
+    struct Chunk
+    {
+      size_t m_begin;
+      size_t m_end;
+    };
+    struct Queue
+    {
+      std::mutex m_mutex;
+      std::deque<Chunk> m_chunks;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief run one chunk, from the back of queue _index or else stolen from the front of another
+    /// @returns false when every queue is empty
+    //----------------------------------------------------------------------------------------------------------------------
+    bool runChunk(size_t _index);
+    void workerLoop(size_t _index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernel of the current parallelFor, published to the workers through the queue mutexes
+    //----------------------------------------------------------------------------------------------------------------------
+    const Kernel *m_kernel;
+    std::atomic<size_t> m_remaining;
+    std::atomic<size_t> m_stolen;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bumped by every parallelFor so a worker knows there is new work, guarded by m_wakeMutex
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_generation;
+    bool m_quit;
+};
+
+} // end namespace rmath
+
+#endif
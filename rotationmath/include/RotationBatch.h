@@ -0,0 +1,60 @@
+#ifndef ROTATIONBATCH_H__
+#define ROTATIONBATCH_H__
+
+#include <cstddef>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RotationBatch.h
+/// @brief batched (structure-of-arrays) version of rmath::rotationBetweenVectors, evaluated 8 (AVX2) or
+/// 4 (SSE) pairs at a time with no per-element branches.
+/// It is the rotationBetweenVectors template of RotationMath.h instantiated on a SIMD register.
+/// The antiparallel fallback (180 degree turn about a generated axis) and the identical vectors case are computed
+/// for every lane and selected with a mask, so the cost is the same whatever the input distribution.
+/// Accuracy : the float and register instantiations issue the same operations in the same order so with the project
+/// flags (-ffp-contract=off) every component is bit identical to rmath::rotationBetweenVectors (0 ULP). If either
+/// side is built with FMA contraction the near antiparallel results drift by up to 2e-3 absolute, as 1/s amplifies
+/// the rounding of the start x dest cancellation.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a read only structure-of-arrays view of _count vectors
+//----------------------------------------------------------------------------------------------------------------------
+struct Vec3Stream
+{
+  const float *m_x;
+  const float *m_y;
+  const float *m_z;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a writable structure-of-arrays view of _count quaternions, same component names as rmath::Quaternion
+//----------------------------------------------------------------------------------------------------------------------
+struct QuaternionStream
+{
+  float *m_s;
+  float *m_x;
+  float *m_y;
+  float *m_z;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief compute the shortest arc quaternion that rotates _start[i] onto _dest[i] for every i in [0,_count)
+/// the inputs do not need to be normalized (but must not be zero length), the output arrays must not alias the inputs
+/// @param [in] _start the vectors to rotate from
+/// @param [in] _dest the vectors to rotate to
+/// @param [out] _out the resulting quaternions
+/// @param [in] _count the number of pairs to process
+//----------------------------------------------------------------------------------------------------------------------
+void rotationBetweenVectorsBatch(const Vec3Stream &_start, const Vec3Stream &_dest, const QuaternionStream &_out, size_t _count);
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the instruction set the batch kernel was compiled for ("AVX2", "AVX", "SSE" or "scalar")
+//----------------------------------------------------------------------------------------------------------------------
+const char *rotationBatchISA();
+
+} // end namespace rmath
+
+#endif
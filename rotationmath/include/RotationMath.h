@@ -0,0 +1,312 @@
+#ifndef ROTATIONMATH_H__
+#define ROTATIONMATH_H__
+
+#include "FastTrig.h"
+
+#include <cmath>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file RotationMath.h
+/// @brief the rotation constructions compared by the demo, free of any Qt / OpenGL / NGL dependency so they can be
+/// used by command line tools and batch jobs on machines with no display.
+/// Every routine is a template on the value type T and computes in T throughout, so the same code instantiates for
+/// float, double or a SIMD register of floats (the library's batch functions run it on 8 (AVX) or 4 (SSE) lanes at
+/// a time). Branches are written as selects on masks so a lane never depends on its neighbours. Vec3, Quaternion and
+/// Mat4 are the float instantiations and have the same member names and memory layout as their ngl counterparts
+/// (ngl::Vec3, ngl::Quaternion and the row major ngl::Mat4). rotationBetweenVectors, fromAxisAngle and toMat4 issue
+/// their float operations in the same order as NGL so the float results are bit identical to it, the double
+/// instantiations are what rotbench measures against.
+/// The routines that use trig also take the accuracy tier as a template argument (see FastTrig.h), the default FULL
+/// is libm, e.g. rmath::matrixFromAxisAngle<rmath::TrigAccuracy::LOW>(axis,angle) trades accuracy for speed at that
+/// call site.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief minimal 3 component vector
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+struct TVec3
+{
+  T m_x;
+  T m_y;
+  T m_z;
+
+  TVec3() : m_x(0.0f), m_y(0.0f), m_z(0.0f) {}
+  TVec3(T _x, T _y, T _z) : m_x(_x), m_y(_y), m_z(_z) {}
+
+  T dot(const TVec3 &_v) const { return m_x*_v.m_x+m_y*_v.m_y+m_z*_v.m_z; }
+  TVec3 cross(const TVec3 &_v) const
+  {
+    return TVec3(m_y*_v.m_z - m_z*_v.m_y,
+                 m_z*_v.m_x - m_x*_v.m_z,
+                 m_x*_v.m_y - m_y*_v.m_x);
+  }
+  T length() const { return squareRoot(m_x*m_x+m_y*m_y+m_z*m_z); }
+  void normalize()
+  {
+    T len=length();
+    m_x=m_x/len;
+    m_y=m_y/len;
+    m_z=m_z/len;
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief quaternion stored as scalar (m_s) and vector (m_x,m_y,m_z) parts, default is the identity
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+struct TQuaternion
+{
+  T m_s;
+  T m_x;
+  T m_y;
+  T m_z;
+
+  TQuaternion() : m_s(1.0f), m_x(0.0f), m_y(0.0f), m_z(0.0f) {}
+  TQuaternion(T _s, T _x, T _y, T _z) : m_s(_s), m_x(_x), m_y(_y), m_z(_z) {}
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief row major 4x4 matrix (translation in m_m[3]), default is the identity
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+struct TMat4
+{
+  T m_m[4][4];
+
+  TMat4()
+  {
+    for(int r=0; r<4; ++r)
+      for(int c=0; c<4; ++c)
+        m_m[r][c]= T(r==c ? 1.0f : 0.0f);
+  }
+};
+
+typedef TVec3<float> Vec3;
+typedef TQuaternion<float> Quaternion;
+typedef TMat4<float> Mat4;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief convert an axis angle rotation to heading / attitude / bank (radians)
+/// Heading = rotation about y axis, Attitude = rotation about z axis, Bank = rotation about x axis
+/// @param [in] _x,_y,_z the normalized rotation axis
+/// @param [in] _angle the angle in radians
+/// @returns (bank,heading,attitude)
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL, typename T>
+TVec3<T> eulerAngles(T _x, T _y, T _z, T _angle)
+{
+  typedef FastTrig<A> Trig;
+  const T zero(0.0f);
+  T s=Trig::sin(_angle);
+  T c=Trig::cos(_angle);
+  T t=T(1.0f)-c;
+  //  if axis is not already normalised then uncomment this
+  // double magnitude = Math.sqrt(x*x + y*y + z*z);
+  // if (magnitude==0) throw error;
+  // x /= magnitude;
+  // y /= magnitude;
+  // z /= magnitude;
+  T pole=_x*_y*t + _z*s;
+  auto north=pole>T(0.998); // north pole singularity detected
+  auto south=pole<T(-0.998); // south pole singularity detected
+  T poleHeading=T(2.0f)*Trig::atan2(_x*Trig::sin(_angle/T(2.0f)),Trig::cos(_angle/T(2.0f)));
+  T heading=Trig::atan2(_y * s- _x * _z * t , T(1.0f) - (_y*_y+ _z*_z ) * t);
+  T attitude=Trig::asin(pole);
+  T bank=Trig::atan2(_x * s - _y * _z * t , T(1.0f) - (_x*_x + _z*_z) * t);
+  heading=select(north,poleHeading,select(south,-poleHeading,heading));
+  attitude=select(north,T(M_PI/2),select(south,T(-M_PI/2),attitude));
+  bank=select(north,zero,select(south,zero,bank));
+  return TVec3<T>(bank,heading,attitude);
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief eulerAngles in double for an axis and angle given in double
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL>
+void toEuler(double _x, double _y, double _z, double _angle, double &o_heading, double &o_attitude, double &o_bank);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief eulerAngles evaluated in double and rounded to float
+/// @returns (bank,heading,attitude)
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL>
+Vec3 toEuler(double _x, double _y, double _z, double _angle);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief build a rotation matrix from a normalized axis and an angle in radians
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL, typename T>
+TMat4<T> matrixFromAxisAngle(TVec3<T> _axis, T _angle)
+{
+  typedef FastTrig<A> Trig;
+  TMat4<T> tmp;
+
+  T c = Trig::cos(_angle);
+  T s = Trig::sin(_angle);
+  T t = T(1.0f) - c;
+  //  if axis is not already normalised then uncomment this
+  // double magnitude = sqrt(axis.x*axis.x + axis.m_y*axis.m_y + axis.m_z*axis.m_z);
+  // if (magnitude==0) throw error;
+  // axis.x /= magnitude;
+  // axis.m_y /= magnitude;
+  // axis.m_z /= magnitude;
+
+  tmp.m_m[0][0] = c + _axis.m_x*_axis.m_x*t;
+  tmp.m_m[1][1] = c + _axis.m_y*_axis.m_y*t;
+  tmp.m_m[2][2] = c + _axis.m_z*_axis.m_z*t;
+
+  T tmp1 = _axis.m_x*_axis.m_y*t;
+  T tmp2 = _axis.m_z*s;
+  tmp.m_m[1][0] = tmp1 + tmp2;
+  tmp.m_m[0][1] = tmp1 - tmp2;
+  tmp1 = _axis.m_x*_axis.m_z*t;
+  tmp2 = _axis.m_y*s;
+  tmp.m_m[2][0] = tmp1 - tmp2;
+  tmp.m_m[0][2] = tmp1 + tmp2;
+  tmp1 = _axis.m_y*_axis.m_z*t;
+  tmp2 = _axis.m_x*s;
+  tmp.m_m[2][1] = tmp1 + tmp2;
+  tmp.m_m[1][2] = tmp1 - tmp2;
+
+  return tmp;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief rotation matrix taking the unit vector _start to the unit vector _dest via acos then cos / sin
+/// http://immersivemath.com/forum/question/rotation-matrix-from-one-vector-to-another/
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL, typename T>
+TMat4<T> deriveRotMatrixToRotateV2toV1(TVec3<T> _start, TVec3<T> _dest)
+{
+  typedef FastTrig<A> Trig;
+  // The classical answer is that you can create an axis of rotation, a=u×v/||u×v||, which is normalized, and
+  // compute the angle between u and v, i.e., α=arccos(u⋅v). With c=cos α and s=sin α, it should be possible to
+  // show that v=Mu.
+  TVec3<T> axis=_start.cross(_dest);
+  axis.normalize();
+  T a=Trig::acos(_start.dot(_dest));
+  T c=Trig::cos(a);
+  T s=Trig::sin(a);
+  T oneMinusC=T(1.0f)-c;
+
+  TMat4<T> rotMat;
+  rotMat.m_m[0][0]=(axis.m_x*axis.m_x)*oneMinusC+c;
+  rotMat.m_m[0][1]=(axis.m_x*axis.m_y)*oneMinusC-s*axis.m_z;
+  rotMat.m_m[0][2]=(axis.m_x*axis.m_z)*oneMinusC+s*axis.m_y;
+  rotMat.m_m[1][0]=(axis.m_x*axis.m_y)*oneMinusC+s*axis.m_z;
+  rotMat.m_m[1][1]=(axis.m_y*axis.m_y)*oneMinusC+c;
+  rotMat.m_m[1][2]=(axis.m_y*axis.m_z)*oneMinusC-s*axis.m_x;
+  rotMat.m_m[2][0]=(axis.m_x*axis.m_z)*oneMinusC-s*axis.m_y;
+  rotMat.m_m[2][1]=(axis.m_y*axis.m_z)*oneMinusC+s*axis.m_x;
+  rotMat.m_m[2][2]=(axis.m_z*axis.m_z)*oneMinusC+c;
+  return rotMat;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief quaternion from an axis and an angle in degrees, as ngl::Quaternion::fromAxisAngle
+//----------------------------------------------------------------------------------------------------------------------
+template<TrigAccuracy A=TrigAccuracy::FULL, typename T>
+TQuaternion<T> fromAxisAngle(TVec3<T> _axis, T _angle)
+{
+  typedef FastTrig<A> Trig;
+  _axis.normalize();
+  _angle=(_angle/T(180.0f))*T(M_PI);
+  T sinAngle=Trig::sin(_angle/T(2.0f));
+  T cosAngle=Trig::cos(_angle/T(2.0f));
+  return TQuaternion<T>(cosAngle,_axis.m_x*sinAngle,_axis.m_y*sinAngle,_axis.m_z*sinAngle);
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief return shortest arc quaternion that rotates _start to _dest (the inputs are normalized first)
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+TQuaternion<T> rotationBetweenVectors(TVec3<T> _start, TVec3<T> _dest)
+{
+  const T zero(0.0f);
+  const T one(1.0f);
+  _start.normalize();
+  _dest.normalize();
+
+  T cosTheta = _start.dot(_dest);
+
+  /**
+   * https://bitbucket.org/sinbad/ogre/src/9db75e3ba05c/OgreMain/include/OgreVector3.h?fileviewer=file-view-default#cl-651
+   *
+   * Gets the shortest arc quaternion to rotate this vector to the destination vector.
+   * If you call this with a dest vector that is close to the inverse of this vector, we will rotate 180 degrees
+   * around a generated axis since in this case ANY axis of rotation is valid.
+   */
+  TVec3<T> rotationAxis = _start.cross(_dest);
+
+  T s = squareRoot( (one+cosTheta)*T(2.0f) );
+  T invs = one / s;
+
+  TQuaternion<T> q(s * T(0.5f),
+                   rotationAxis.m_x * invs,
+                   rotationAxis.m_y * invs,
+                   rotationAxis.m_z * invs);
+
+  // the 180 degree turn is worked out for every lane and selected, so the cost does not depend on the input
+  auto antiparallel=cosTheta < T(1e-6f - 1.0f);
+  // Generate an axis
+  TVec3<T> axis = TVec3<T>(zero, zero, one).cross(_start);
+  TVec3<T> other = TVec3<T>(zero, one, zero).cross(_start);
+  // pick another if colinear
+  auto colinear = axis.length()==zero;
+  axis = TVec3<T>(select(colinear,other.m_x,axis.m_x),
+                  select(colinear,other.m_y,axis.m_y),
+                  select(colinear,other.m_z,axis.m_z));
+  axis.normalize();
+  // fromAxisAngle(axis,180) with the half turn sin / cos worked out once, in the lane precision
+  typedef typename LaneScalar<T>::type Scalar;
+  static const Scalar s_halfTurnAngle=(Scalar(180.0f)/Scalar(180.0f))*Scalar(M_PI);
+  static const Scalar s_halfTurnSin=std::sin(s_halfTurnAngle/Scalar(2.0f));
+  static const Scalar s_halfTurnCos=std::cos(s_halfTurnAngle/Scalar(2.0f));
+  axis.normalize();
+  q = TQuaternion<T>(select(antiparallel,T(s_halfTurnCos),q.m_s),
+                     select(antiparallel,axis.m_x*T(s_halfTurnSin),q.m_x),
+                     select(antiparallel,axis.m_y*T(s_halfTurnSin),q.m_y),
+                     select(antiparallel,axis.m_z*T(s_halfTurnSin),q.m_z));
+
+  //same vectors
+  auto same=cosTheta >= one;
+  return TQuaternion<T>(select(same,one,q.m_s),
+                        select(same,zero,q.m_x),
+                        select(same,zero,q.m_y),
+                        select(same,zero,q.m_z));
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief quaternion to rotation matrix, as ngl::Quaternion::toMat4
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+TMat4<T> toMat4(const TQuaternion<T> &_q)
+{
+  T x2=_q.m_x+_q.m_x;
+  T y2=_q.m_y+_q.m_y;
+  T z2=_q.m_z+_q.m_z;
+  T xx=_q.m_x*x2;
+  T xy=_q.m_x*y2;
+  T xz=_q.m_x*z2;
+  T yy=_q.m_y*y2;
+  T yz=_q.m_y*z2;
+  T zz=_q.m_z*z2;
+  T wx=_q.m_s*x2;
+  T wy=_q.m_s*y2;
+  T wz=_q.m_s*z2;
+
+  TMat4<T> o;
+  o.m_m[0][0]=T(1.0f)-(yy+zz);
+  o.m_m[1][0]=xy-wz;
+  o.m_m[2][0]=xz+wy;
+
+  o.m_m[0][1]=xy+wz;
+  o.m_m[1][1]=T(1.0f)-(xx+zz);
+  o.m_m[2][1]=yz-wx;
+
+  o.m_m[0][2]=xz-wy;
+  o.m_m[1][2]=yz+wx;
+  o.m_m[2][2]=T(1.0f)-(xx+yy);
+  return o;
+}
+
+} // end namespace rmath
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef TRANSFORMSTORE_H__
+#define TRANSFORMSTORE_H__
+
+#include "AlignedAllocator.h"
+#include "Animation.h"
+#include "RotationMath.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformStore.h
+/// @brief the position, rotation, scale and bounding sphere radius of every object in structure-of-arrays form. Each component is its own
+/// cache line aligned float array and the live transforms are packed at the front of them, so batch updates
+/// (AnimationSet::sample, rotationBetweenVectorsBatch) write straight into the store through poses() and
+/// worldMatrices walks every array front to back. Objects are named by handles that stay valid while the arrays
+/// are repacked : destroy moves the last transform into the hole and fixes up its handle. A root transform is
+/// applied after every object's own, world = scale * rotation * translation * root (ngl's row vector order).
+/// Creating objects only grows the arrays, after reserve there is no allocation at all.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace rmath
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief names one transform of a TransformStore, a destroyed transform's handle is recognised by its generation
+//----------------------------------------------------------------------------------------------------------------------
+struct TransformHandle
+{
+  uint32_t m_slot;
+  uint32_t m_generation;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TransformStore
+/// @brief the handle taking functions expect a valid handle, check with isValid when unsure
+//----------------------------------------------------------------------------------------------------------------------
+class TransformStore
+{
+  public:
+    TransformStore();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief make room for _count transforms so creating up to that many allocates nothing
+    //----------------------------------------------------------------------------------------------------------------------
+    void reserve(size_t _count);
+    TransformHandle create(const Vec3 &_position=Vec3(), const Quaternion &_rotation=Quaternion(),
+                           const Vec3 &_scale=Vec3(1.0f,1.0f,1.0f));
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief remove the transform, the last one in the arrays takes its index
+    //----------------------------------------------------------------------------------------------------------------------
+    void destroy(TransformHandle _handle);
+    bool isValid(TransformHandle _handle) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief destroy every transform, outstanding handles become invalid
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    size_t size() const { return m_positionX.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the transform is in the arrays, only changes when a destroy moves it
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t indexOf(TransformHandle _handle) const { return m_slots[_handle.m_slot].m_index; }
+    TransformHandle handleAt(size_t _index) const;
+
+    void setPosition(TransformHandle _handle, const Vec3 &_position);
+    void setRotation(TransformHandle _handle, const Quaternion &_rotation);
+    void setScale(TransformHandle _handle, const Vec3 &_scale);
+    Vec3 position(TransformHandle _handle) const;
+    Quaternion rotation(TransformHandle _handle) const;
+    Vec3 scale(TransformHandle _handle) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief radius of the object's bounding sphere about its position, with the object's scale applied (0 when new)
+    //----------------------------------------------------------------------------------------------------------------------
+    void setBoundingRadius(TransformHandle _handle, float _radius);
+    float boundingRadius(TransformHandle _handle) const { return m_radius[indexOf(_handle)]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writable streams over the positions and rotations of every transform (size() entries), invalidated by
+    /// create, destroy and reserve
+    //----------------------------------------------------------------------------------------------------------------------
+    PoseStream poses();
+    Vec3Stream positions() const;
+    Vec3Stream scales() const;
+    const float *boundingRadii() const { return m_radius.data(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the transform applied after every object's own, the identity by default
+    //----------------------------------------------------------------------------------------------------------------------
+    void setRoot(const Mat4 &_root) { m_root=_root; }
+    const Mat4 &root() const { return m_root; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief scale * rotation * translation * root of the transform at _index
+    //----------------------------------------------------------------------------------------------------------------------
+    Mat4 worldMatrix(size_t _index) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the world matrices of the transforms [_begin,_end) into o_out[0 .. _end-_begin), disjoint ranges can
+    /// be built concurrently
+    //----------------------------------------------------------------------------------------------------------------------
+    void worldMatrices(size_t _begin, size_t _end, Mat4 *o_out) const;
+
+  private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a live slot holds the transform's index, a free one the next free slot
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Slot
+    {
+      uint32_t m_index;
+      uint32_t m_generation;
+    };
+    static const uint32_t NO_SLOT=0xffffffffu;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief every component array, for the operations that treat them all alike
+    //----------------------------------------------------------------------------------------------------------------------
+    std::array<AlignedFloats *,11> components();
+
+    std::vector<Slot> m_slots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the slot of the transform at each index, to fix up the handle of the one moved by destroy
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<uint32_t> m_slotOf;
+    uint32_t m_firstFree;
+    AlignedFloats m_positionX;
+    AlignedFloats m_positionY;
+    AlignedFloats m_positionZ;
+    AlignedFloats m_rotationS;
+    AlignedFloats m_rotationX;
+    AlignedFloats m_rotationY;
+    AlignedFloats m_rotationZ;
+    AlignedFloats m_scaleX;
+    AlignedFloats m_scaleY;
+    AlignedFloats m_scaleZ;
+    AlignedFloats m_radius;
+    Mat4 m_root;
+};
+
+} // end namespace rmath
+
+#endif
@@ -0,0 +1,24 @@
+# headless rotation maths, no Qt / OpenGL / NGL so it can be linked into
+# command line tools and batch jobs as well as the demo
+TARGET=RotationMath
+TEMPLATE=lib
+CONFIG+=staticlib
+CONFIG+=c++11
+# no Qt in this library
+CONFIG-=qt
+# where to put the .o files
+OBJECTS_DIR=obj
+# the library lives in the lib dir of the project root
+DESTDIR=$$PWD/../lib
+SOURCES+= $$PWD/src/*.cpp
+HEADERS+= $$PWD/include/*.h
+# private to the library (SimdISA.h)
+HEADERS+= $$PWD/src/*.h
+INCLUDEPATH +=$$PWD/include
+# basic compiler flags (not all appropriate for all platforms)
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+# don't let the compiler fuse multiply / adds, keeps RotationBatch bit identical to the scalar rotation code
+QMAKE_CXXFLAGS+= -ffp-contract=off
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+linux-*:QMAKE_CXXFLAGS +=  -march=native
+win32:DEFINES+=_USE_MATH_DEFINES
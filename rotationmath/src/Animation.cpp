@@ -0,0 +1,300 @@
+#include "Animation.h"
+#include "SimdISA.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+using rmath::simd::ISA;
+typedef ISA::V V;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief tracks gathered and interpolated together, a multiple of every ISA::Width
+//----------------------------------------------------------------------------------------------------------------------
+const size_t SAMPLE_BLOCK=64;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief structure-of-arrays scratch for one block, the bracketing keys in, the pose out
+//----------------------------------------------------------------------------------------------------------------------
+struct SampleBlock
+{
+  float m_positionT[SAMPLE_BLOCK];
+  float m_p0[3][SAMPLE_BLOCK];
+  float m_p1[3][SAMPLE_BLOCK];
+  float m_rotationT[SAMPLE_BLOCK];
+  float m_q0[4][SAMPLE_BLOCK];
+  float m_q1[4][SAMPLE_BLOCK];
+  float m_position[3][SAMPLE_BLOCK];
+  float m_rotation[4][SAMPLE_BLOCK];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief lerp ISA::Width positions
+//----------------------------------------------------------------------------------------------------------------------
+inline void lerpKernel(SampleBlock &io_block, size_t _i)
+{
+  V t=ISA::load(&io_block.m_positionT[_i]);
+  for(int c=0; c<3; ++c)
+  {
+    V a=ISA::load(&io_block.m_p0[c][_i]);
+    V b=ISA::load(&io_block.m_p1[c][_i]);
+    ISA::store(&io_block.m_position[c][_i],ISA::add(a,ISA::mul(ISA::sub(b,a),t)));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief nlerp (or corrected nlerp for slerp) ISA::Width quaternions, same operation order as rmath::nlerp
+//----------------------------------------------------------------------------------------------------------------------
+inline void nlerpKernel(SampleBlock &io_block, size_t _i, bool _slerp)
+{
+  const V zero=ISA::set1(0.0f);
+  V t=ISA::load(&io_block.m_rotationT[_i]);
+  V a[4];
+  V b[4];
+  for(int c=0; c<4; ++c)
+  {
+    a[c]=ISA::load(&io_block.m_q0[c][_i]);
+    b[c]=ISA::load(&io_block.m_q1[c][_i]);
+  }
+  V d=ISA::add(ISA::add(ISA::add(ISA::mul(a[0],b[0]),ISA::mul(a[1],b[1])),ISA::mul(a[2],b[2])),ISA::mul(a[3],b[3]));
+  // take the shortest arc
+  V flip=ISA::cmpLt(d,zero);
+  for(int c=0; c<4; ++c)
+  {
+    b[c]=ISA::select(flip,ISA::sub(zero,b[c]),b[c]);
+  }
+  if(_slerp)
+  {
+    // move t so the nlerp angle tracks the slerp angle, the fit is in |cos| of the angle between the keys
+    d=ISA::select(flip,ISA::sub(zero,d),d);
+    V A=ISA::add(ISA::set1(1.0904f),ISA::mul(d,ISA::add(ISA::set1(-3.2452f),
+                                    ISA::mul(d,ISA::sub(ISA::set1(3.55645f),ISA::mul(d,ISA::set1(1.43519f)))))));
+    V B=ISA::add(ISA::set1(0.848013f),ISA::mul(d,ISA::add(ISA::set1(-1.06021f),ISA::mul(d,ISA::set1(0.215638f)))));
+    V tHalf=ISA::sub(t,ISA::set1(0.5f));
+    V k=ISA::add(ISA::mul(ISA::mul(A,tHalf),tHalf),B);
+    t=ISA::add(t,ISA::mul(ISA::mul(ISA::mul(t,tHalf),ISA::sub(t,ISA::set1(1.0f))),k));
+  }
+  V q[4];
+  for(int c=0; c<4; ++c)
+  {
+    q[c]=ISA::add(a[c],ISA::mul(ISA::sub(b[c],a[c]),t));
+  }
+  V len=ISA::sqrt(ISA::add(ISA::add(ISA::add(ISA::mul(q[0],q[0]),ISA::mul(q[1],q[1])),ISA::mul(q[2],q[2])),
+                           ISA::mul(q[3],q[3])));
+  for(int c=0; c<4; ++c)
+  {
+    ISA::store(&io_block.m_rotation[c][_i],ISA::div(q[c],len));
+  }
+}
+
+} // end anon namespace
+
+namespace rmath
+{
+
+Quaternion nlerp(const Quaternion &_a, const Quaternion &_b, float _t)
+{
+  Quaternion b=_b;
+  float d=_a.m_s*b.m_s+_a.m_x*b.m_x+_a.m_y*b.m_y+_a.m_z*b.m_z;
+  if(d<0.0f)
+  {
+    b=Quaternion(0.0f-b.m_s,0.0f-b.m_x,0.0f-b.m_y,0.0f-b.m_z);
+  }
+  Quaternion q(_a.m_s+(b.m_s-_a.m_s)*_t,
+               _a.m_x+(b.m_x-_a.m_x)*_t,
+               _a.m_y+(b.m_y-_a.m_y)*_t,
+               _a.m_z+(b.m_z-_a.m_z)*_t);
+  float len=std::sqrt(q.m_s*q.m_s+q.m_x*q.m_x+q.m_y*q.m_y+q.m_z*q.m_z);
+  return Quaternion(q.m_s/len,q.m_x/len,q.m_y/len,q.m_z/len);
+}
+
+Quaternion slerp(const Quaternion &_a, const Quaternion &_b, float _t)
+{
+  double b[4]={_b.m_s,_b.m_x,_b.m_y,_b.m_z};
+  double d=_a.m_s*b[0]+_a.m_x*b[1]+_a.m_y*b[2]+_a.m_z*b[3];
+  if(d<0.0)
+  {
+    d=-d;
+    for(double &c : b)
+    {
+      c=-c;
+    }
+  }
+  double wa=1.0-_t;
+  double wb=_t;
+  // nearly the same key, sin(theta) is too small to divide by and the blend is linear anyway
+  if(d<0.9999)
+  {
+    double theta=std::acos(d);
+    double sinTheta=std::sin(theta);
+    wa=std::sin((1.0-_t)*theta)/sinTheta;
+    wb=std::sin(_t*theta)/sinTheta;
+  }
+  double q[4]={wa*_a.m_s+wb*b[0],wa*_a.m_x+wb*b[1],wa*_a.m_y+wb*b[2],wa*_a.m_z+wb*b[3]};
+  double len=std::sqrt(q[0]*q[0]+q[1]*q[1]+q[2]*q[2]+q[3]*q[3]);
+  return Quaternion(static_cast<float>(q[0]/len),static_cast<float>(q[1]/len),
+                    static_cast<float>(q[2]/len),static_cast<float>(q[3]/len));
+}
+
+AnimationSet::AnimationSet()
+{
+  m_duration=0.0f;
+}
+
+size_t AnimationSet::addTrack(const std::vector<PositionKey> &_positions, const std::vector<RotationKey> &_rotations)
+{
+  KeyRange positions={m_positionTime.size(),_positions.size()};
+  for(const PositionKey &key : _positions)
+  {
+    m_positionTime.push_back(key.m_time);
+    m_positionX.push_back(key.m_value.m_x);
+    m_positionY.push_back(key.m_value.m_y);
+    m_positionZ.push_back(key.m_value.m_z);
+    m_duration=std::max(m_duration,key.m_time);
+  }
+  KeyRange rotations={m_rotationTime.size(),_rotations.size()};
+  for(const RotationKey &key : _rotations)
+  {
+    m_rotationTime.push_back(key.m_time);
+    m_rotationS.push_back(key.m_value.m_s);
+    m_rotationX.push_back(key.m_value.m_x);
+    m_rotationY.push_back(key.m_value.m_y);
+    m_rotationZ.push_back(key.m_value.m_z);
+    m_duration=std::max(m_duration,key.m_time);
+  }
+  m_positionRange.push_back(positions);
+  m_rotationRange.push_back(rotations);
+  return m_positionRange.size()-1;
+}
+
+void AnimationSet::clear()
+{
+  for(std::vector<float> *keys : {&m_positionTime,&m_positionX,&m_positionY,&m_positionZ,
+                                  &m_rotationTime,&m_rotationS,&m_rotationX,&m_rotationY,&m_rotationZ})
+  {
+    keys->clear();
+  }
+  m_positionRange.clear();
+  m_rotationRange.clear();
+  m_duration=0.0f;
+}
+
+size_t AnimationSet::findKey(const std::vector<float> &_times, const KeyRange &_range, float _time, size_t &o_next, float &o_t)
+{
+  const float *first=&_times[_range.m_first];
+  const float *last=first+_range.m_count-1;
+  o_t=0.0f;
+  if(_time<=*first)
+  {
+    o_next=_range.m_first;
+    return o_next;
+  }
+  if(_time>=*last)
+  {
+    o_next=_range.m_first+_range.m_count-1;
+    return o_next;
+  }
+  size_t key=static_cast<size_t>(std::upper_bound(first,last+1,_time)-first)-1;
+  o_t=(_time-first[key])/(first[key+1]-first[key]);
+  o_next=_range.m_first+key+1;
+  return _range.m_first+key;
+}
+
+void AnimationSet::sampleRange(float _time, size_t _begin, size_t _end, const PoseStream &_out, RotationInterpolation _mode) const
+{
+  const size_t width=ISA::Width;
+  SampleBlock block;
+  for(size_t start=_begin; start<_end; start+=SAMPLE_BLOCK)
+  {
+    size_t count=std::min(SAMPLE_BLOCK,_end-start);
+    // gather the bracketing keys of every track in the block
+    for(size_t i=0; i<count; ++i)
+    {
+      size_t next;
+      size_t key=findKey(m_positionTime,m_positionRange[start+i],_time,next,block.m_positionT[i]);
+      block.m_p0[0][i]=m_positionX[key];
+      block.m_p0[1][i]=m_positionY[key];
+      block.m_p0[2][i]=m_positionZ[key];
+      block.m_p1[0][i]=m_positionX[next];
+      block.m_p1[1][i]=m_positionY[next];
+      block.m_p1[2][i]=m_positionZ[next];
+
+      key=findKey(m_rotationTime,m_rotationRange[start+i],_time,next,block.m_rotationT[i]);
+      block.m_q0[0][i]=m_rotationS[key];
+      block.m_q0[1][i]=m_rotationX[key];
+      block.m_q0[2][i]=m_rotationY[key];
+      block.m_q0[3][i]=m_rotationZ[key];
+      block.m_q1[0][i]=m_rotationS[next];
+      block.m_q1[1][i]=m_rotationX[next];
+      block.m_q1[2][i]=m_rotationY[next];
+      block.m_q1[3][i]=m_rotationZ[next];
+    }
+    // pad the last partial vector with identity keys so every lane stays finite
+    size_t padded=(count+width-1)/width*width;
+    for(size_t i=count; i<padded; ++i)
+    {
+      block.m_positionT[i]=block.m_rotationT[i]=0.0f;
+      for(int c=0; c<3; ++c)
+      {
+        block.m_p0[c][i]=block.m_p1[c][i]=0.0f;
+      }
+      for(int c=0; c<4; ++c)
+      {
+        block.m_q0[c][i]=block.m_q1[c][i]= c==0 ? 1.0f : 0.0f;
+      }
+    }
+    for(size_t i=0; i<padded; i+=width)
+    {
+      lerpKernel(block,i);
+      nlerpKernel(block,i,_mode==RotationInterpolation::SLERP);
+    }
+    std::copy(block.m_position[0],block.m_position[0]+count,_out.m_x+start);
+    std::copy(block.m_position[1],block.m_position[1]+count,_out.m_y+start);
+    std::copy(block.m_position[2],block.m_position[2]+count,_out.m_z+start);
+    std::copy(block.m_rotation[0],block.m_rotation[0]+count,_out.m_rotation.m_s+start);
+    std::copy(block.m_rotation[1],block.m_rotation[1]+count,_out.m_rotation.m_x+start);
+    std::copy(block.m_rotation[2],block.m_rotation[2]+count,_out.m_rotation.m_y+start);
+    std::copy(block.m_rotation[3],block.m_rotation[3]+count,_out.m_rotation.m_z+start);
+  }
+}
+
+void AnimationSet::sample(float _time, const PoseStream &_out, RotationInterpolation _mode, JobSystem *_jobs) const
+{
+  size_t count=trackCount();
+  if(_jobs==nullptr)
+  {
+    sampleRange(_time,0,count,_out,_mode);
+    return;
+  }
+  // whole blocks per chunk so only the last chunk has a partial block
+  _jobs->parallelFor(count,SAMPLE_BLOCK,[&](size_t _begin, size_t _end)
+  {
+    sampleRange(_time,_begin,_end,_out,_mode);
+  });
+}
+
+void AnimationSet::sampleReference(float _time, const PoseStream &_out, RotationInterpolation _mode) const
+{
+  for(size_t i=0; i<trackCount(); ++i)
+  {
+    size_t next;
+    float t;
+    size_t key=findKey(m_positionTime,m_positionRange[i],_time,next,t);
+    _out.m_x[i]=m_positionX[key]+(m_positionX[next]-m_positionX[key])*t;
+    _out.m_y[i]=m_positionY[key]+(m_positionY[next]-m_positionY[key])*t;
+    _out.m_z[i]=m_positionZ[key]+(m_positionZ[next]-m_positionZ[key])*t;
+
+    key=findKey(m_rotationTime,m_rotationRange[i],_time,next,t);
+    Quaternion a(m_rotationS[key],m_rotationX[key],m_rotationY[key],m_rotationZ[key]);
+    Quaternion b(m_rotationS[next],m_rotationX[next],m_rotationY[next],m_rotationZ[next]);
+    Quaternion q= _mode==RotationInterpolation::SLERP ? slerp(a,b,t) : nlerp(a,b,t);
+    _out.m_rotation.m_s[i]=q.m_s;
+    _out.m_rotation.m_x[i]=q.m_x;
+    _out.m_rotation.m_y[i]=q.m_y;
+    _out.m_rotation.m_z[i]=q.m_z;
+  }
+}
+
+} // end namespace rmath
@@ -0,0 +1,135 @@
+#include "FastTrig.h"
+#include "SimdISA.h"
+
+namespace
+{
+
+using rmath::simd::Float;
+using rmath::simd::ISA;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief run _f over whole registers then finish the tail with the float instantiation of the same kernel
+//----------------------------------------------------------------------------------------------------------------------
+template<typename F>
+inline void unary(const float *_in, float *_out, size_t _count, F _f)
+{
+  const size_t width=ISA::Width;
+  size_t i=0;
+  for(; i+width<=_count; i+=width)
+  {
+    _f(Float::load(_in+i)).store(_out+i);
+  }
+  for(; i<_count; ++i)
+  {
+    _out[i]=_f(_in[i]);
+  }
+}
+
+template<typename F>
+inline void binary(const float *_a, const float *_b, float *_out, size_t _count, F _f)
+{
+  const size_t width=ISA::Width;
+  size_t i=0;
+  for(; i+width<=_count; i+=width)
+  {
+    _f(Float::load(_a+i),Float::load(_b+i)).store(_out+i);
+  }
+  for(; i<_count; ++i)
+  {
+    _out[i]=_f(_a[i],_b[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the kernels as function objects so one call site takes both Float and float
+//----------------------------------------------------------------------------------------------------------------------
+template<rmath::TrigAccuracy A>
+struct Sin { template<typename T> T operator()(T _x) const { return rmath::FastTrig<A>::sin(_x); } };
+template<rmath::TrigAccuracy A>
+struct Cos { template<typename T> T operator()(T _x) const { return rmath::FastTrig<A>::cos(_x); } };
+template<rmath::TrigAccuracy A>
+struct Atan2 { template<typename T> T operator()(T _y, T _x) const { return rmath::FastTrig<A>::atan2(_y,_x); } };
+template<rmath::TrigAccuracy A>
+struct Acos { template<typename T> T operator()(T _x) const { return rmath::FastTrig<A>::acos(_x); } };
+template<rmath::TrigAccuracy A>
+struct Asin { template<typename T> T operator()(T _x) const { return rmath::FastTrig<A>::asin(_x); } };
+
+} // end anonymous namespace
+
+namespace rmath
+{
+
+template<TrigAccuracy A>
+void FastTrig<A>::sin(const float *_in, float *_out, size_t _count)
+{
+  unary(_in,_out,_count,Sin<A>());
+}
+
+template<TrigAccuracy A>
+void FastTrig<A>::cos(const float *_in, float *_out, size_t _count)
+{
+  unary(_in,_out,_count,Cos<A>());
+}
+
+template<TrigAccuracy A>
+void FastTrig<A>::atan2(const float *_y, const float *_x, float *_out, size_t _count)
+{
+  binary(_y,_x,_out,_count,Atan2<A>());
+}
+
+template<TrigAccuracy A>
+void FastTrig<A>::acos(const float *_in, float *_out, size_t _count)
+{
+  unary(_in,_out,_count,Acos<A>());
+}
+
+template<TrigAccuracy A>
+void FastTrig<A>::asin(const float *_in, float *_out, size_t _count)
+{
+  unary(_in,_out,_count,Asin<A>());
+}
+
+template class FastTrig<TrigAccuracy::LOW>;
+template class FastTrig<TrigAccuracy::MEDIUM>;
+
+void FastTrig<TrigAccuracy::FULL>::sin(const float *_in, float *_out, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    _out[i]=std::sin(_in[i]);
+  }
+}
+
+void FastTrig<TrigAccuracy::FULL>::cos(const float *_in, float *_out, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    _out[i]=std::cos(_in[i]);
+  }
+}
+
+void FastTrig<TrigAccuracy::FULL>::atan2(const float *_y, const float *_x, float *_out, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    _out[i]=std::atan2(_y[i],_x[i]);
+  }
+}
+
+void FastTrig<TrigAccuracy::FULL>::acos(const float *_in, float *_out, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    _out[i]=std::acos(clampUnit(_in[i]));
+  }
+}
+
+void FastTrig<TrigAccuracy::FULL>::asin(const float *_in, float *_out, size_t _count)
+{
+  for(size_t i=0; i<_count; ++i)
+  {
+    _out[i]=std::asin(clampUnit(_in[i]));
+  }
+}
+
+} // end namespace rmath
@@ -0,0 +1,86 @@
+#include "FrustumCull.h"
+#include "SimdISA.h"
+
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the smallest over the planes of signed distance plus radius, the sphere is outside when it is negative.
+/// A template so the register blocks and the scalar tail are the same code
+//----------------------------------------------------------------------------------------------------------------------
+template<typename T>
+inline T worstPlane(const T _planes[][4], T _x, T _y, T _z, T _r)
+{
+  using rmath::minimum;
+  T worst=_planes[0][0]*_x+_planes[0][1]*_y+_planes[0][2]*_z+_planes[0][3]+_r;
+  for(int p=1; p<rmath::Frustum::PLANECOUNT; ++p)
+  {
+    worst=minimum(worst,_planes[p][0]*_x+_planes[p][1]*_y+_planes[p][2]*_z+_planes[p][3]+_r);
+  }
+  return worst;
+}
+
+} // end anonymous namespace
+
+namespace rmath
+{
+
+Frustum frustumFromMatrix(const Mat4 &_m)
+{
+  // clip = v * _m, a point is inside when -w <= x,y,z <= w so each plane is the w column plus or minus another
+  const float (*m)[4]=_m.m_m;
+  Frustum f;
+  for(int p=0; p<Frustum::PLANECOUNT; ++p)
+  {
+    int column=p/2;
+    float sign= (p%2)==0 ? 1.0f : -1.0f;
+    for(int k=0; k<4; ++k)
+    {
+      f.m_planes[p][k]=m[k][3]+sign*m[k][column];
+    }
+    float length=std::sqrt(f.m_planes[p][0]*f.m_planes[p][0]+f.m_planes[p][1]*f.m_planes[p][1]+
+                           f.m_planes[p][2]*f.m_planes[p][2]);
+    for(int k=0; k<4; ++k)
+    {
+      f.m_planes[p][k]/=length;
+    }
+  }
+  return f;
+}
+
+size_t cullSpheres(const Frustum &_frustum, const Vec3Stream &_centres, const float *_radii, size_t _begin, size_t _end,
+                   uint32_t *o_visible)
+{
+  using simd::Float;
+  const size_t width=simd::ISA::Width;
+  Float planes[Frustum::PLANECOUNT][4];
+  for(int p=0; p<Frustum::PLANECOUNT; ++p)
+    for(int k=0; k<4; ++k)
+      planes[p][k]=Float(_frustum.m_planes[p][k]);
+
+  size_t count=0;
+  size_t i=_begin;
+  for(; i+width<=_end; i+=width)
+  {
+    Float worst=worstPlane(planes,Float::load(_centres.m_x+i),Float::load(_centres.m_y+i),Float::load(_centres.m_z+i),
+                           Float::load(_radii+i));
+    int inside=simd::laneBits(worst>=Float(0.0f));
+    // every lane writes its index, only the inside ones move the end of the list on
+    for(size_t lane=0; lane<width; ++lane)
+    {
+      o_visible[count]=static_cast<uint32_t>(i+lane);
+      count+=(inside>>lane)&1;
+    }
+  }
+  for(; i<_end; ++i)
+  {
+    float worst=worstPlane(_frustum.m_planes,_centres.m_x[i],_centres.m_y[i],_centres.m_z[i],_radii[i]);
+    o_visible[count]=static_cast<uint32_t>(i);
+    count+= worst>=0.0f ? 1 : 0;
+  }
+  return count;
+}
+
+} // end namespace rmath
@@ -0,0 +1,146 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace rmath
+{
+
+JobSystem::JobSystem(size_t _threads)
+{
+  if(_threads==0)
+  {
+    _threads=std::max(1u,std::thread::hardware_concurrency());
+  }
+  m_kernel=nullptr;
+  m_remaining=0;
+  m_stolen=0;
+  m_generation=0;
+  m_quit=false;
+  for(size_t i=0; i<_threads; ++i)
+  {
+    m_queues.emplace_back(new Queue);
+  }
+  // queue 0 belongs to the thread calling parallelFor
+  for(size_t i=1; i<_threads; ++i)
+  {
+    m_workers.emplace_back(&JobSystem::workerLoop,this,i);
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_quit=true;
+  }
+  m_wake.notify_all();
+  for(std::thread &worker : m_workers)
+  {
+    worker.join();
+  }
+}
+
+void JobSystem::parallelFor(size_t _count, size_t _grain, const Kernel &_kernel)
+{
+  _grain=std::max<size_t>(_grain,1);
+  const size_t threads=threadCount();
+  if(threads==1 || _count<=_grain)
+  {
+    _kernel(0,_count);
+    return;
+  }
+  // about four chunks per thread leaves room to steal without making the chunks tiny
+  size_t grains=(_count+_grain-1)/_grain;
+  size_t chunkGrains=std::max<size_t>(1,grains/(threads*4));
+  size_t chunkSize=chunkGrains*_grain;
+  size_t chunks=(_count+chunkSize-1)/chunkSize;
+
+  m_kernel=&_kernel;
+  m_remaining.store(chunks,std::memory_order_relaxed);
+  // contiguous runs of chunks per queue so each thread starts on its own stretch of memory
+  for(size_t q=0; q<threads; ++q)
+  {
+    size_t first=chunks*q/threads;
+    size_t last=chunks*(q+1)/threads;
+    std::lock_guard<std::mutex> lock(m_queues[q]->m_mutex);
+    for(size_t c=first; c<last; ++c)
+    {
+      m_queues[q]->m_chunks.push_back({c*chunkSize,std::min(_count,(c+1)*chunkSize)});
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    ++m_generation;
+  }
+  m_wake.notify_all();
+
+  while(runChunk(0))
+  {
+  }
+  // the last chunks may still be running on other threads
+  while(m_remaining.load(std::memory_order_acquire)!=0)
+  {
+    std::this_thread::yield();
+  }
+  m_kernel=nullptr;
+}
+
+bool JobSystem::runChunk(size_t _index)
+{
+  Chunk chunk;
+  bool found=false;
+  {
+    Queue &own=*m_queues[_index];
+    std::lock_guard<std::mutex> lock(own.m_mutex);
+    if(!own.m_chunks.empty())
+    {
+      // newest first from our own queue, it is the one most likely still in cache
+      chunk=own.m_chunks.back();
+      own.m_chunks.pop_back();
+      found=true;
+    }
+  }
+  for(size_t i=1; !found && i<m_queues.size(); ++i)
+  {
+    Queue &victim=*m_queues[(_index+i)%m_queues.size()];
+    std::lock_guard<std::mutex> lock(victim.m_mutex);
+    if(!victim.m_chunks.empty())
+    {
+      // oldest from someone else's, the far end from where its owner is working
+      chunk=victim.m_chunks.front();
+      victim.m_chunks.pop_front();
+      m_stolen.fetch_add(1,std::memory_order_relaxed);
+      found=true;
+    }
+  }
+  if(!found)
+  {
+    return false;
+  }
+  (*m_kernel)(chunk.m_begin,chunk.m_end);
+  m_remaining.fetch_sub(1,std::memory_order_acq_rel);
+  return true;
+}
+
+void JobSystem::workerLoop(size_t _index)
+{
+  size_t seen=0;
+  for(;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait(lock,[&](){ return m_quit || m_generation!=seen; });
+      if(m_quit)
+      {
+        return;
+      }
+      seen=m_generation;
+    }
+    // chunks are only added before the wake up so once every queue is empty this call's work is all taken
+    while(runChunk(_index))
+    {
+    }
+  }
+}
+
+} // end namespace rmath
@@ -0,0 +1,40 @@
+#include "RotationBatch.h"
+#include "RotationMath.h"
+#include "SimdISA.h"
+
+namespace rmath
+{
+
+void rotationBetweenVectorsBatch(const Vec3Stream &_start, const Vec3Stream &_dest, const QuaternionStream &_out, size_t _count)
+{
+  using simd::Float;
+  const size_t width=simd::ISA::Width;
+  size_t i=0;
+  for(; i+width<=_count; i+=width)
+  {
+    TQuaternion<Float> q=rotationBetweenVectors(
+          TVec3<Float>(Float::load(_start.m_x+i),Float::load(_start.m_y+i),Float::load(_start.m_z+i)),
+          TVec3<Float>(Float::load(_dest.m_x+i),Float::load(_dest.m_y+i),Float::load(_dest.m_z+i)));
+    q.m_s.store(_out.m_s+i);
+    q.m_x.store(_out.m_x+i);
+    q.m_y.store(_out.m_y+i);
+    q.m_z.store(_out.m_z+i);
+  }
+  // the float instantiation is the same code so the remainder matches the lanes bit for bit
+  for(; i<_count; ++i)
+  {
+    Quaternion q=rotationBetweenVectors(Vec3(_start.m_x[i],_start.m_y[i],_start.m_z[i]),
+                                        Vec3(_dest.m_x[i],_dest.m_y[i],_dest.m_z[i]));
+    _out.m_s[i]=q.m_s;
+    _out.m_x[i]=q.m_x;
+    _out.m_y[i]=q.m_y;
+    _out.m_z[i]=q.m_z;
+  }
+}
+
+const char *rotationBatchISA()
+{
+  return simd::ISA::name();
+}
+
+} // end namespace rmath
@@ -0,0 +1,29 @@
+#include "RotationMath.h"
+
+namespace rmath
+{
+
+template<TrigAccuracy A>
+void toEuler(double _x, double _y, double _z, double _angle, double &o_heading, double &o_attitude, double &o_bank)
+{
+  TVec3<double> angles=eulerAngles<A>(_x,_y,_z,_angle);
+  o_heading=angles.m_y;
+  o_attitude=angles.m_z;
+  o_bank=angles.m_x;
+}
+
+template<TrigAccuracy A>
+Vec3 toEuler(double _x, double _y, double _z, double _angle)
+{
+  TVec3<double> angles=eulerAngles<A>(_x,_y,_z,_angle);
+  return Vec3(static_cast<float>(angles.m_x),static_cast<float>(angles.m_y),static_cast<float>(angles.m_z));
+}
+
+template void toEuler<TrigAccuracy::LOW>(double,double,double,double,double &,double &,double &);
+template void toEuler<TrigAccuracy::MEDIUM>(double,double,double,double,double &,double &,double &);
+template void toEuler<TrigAccuracy::FULL>(double,double,double,double,double &,double &,double &);
+template Vec3 toEuler<TrigAccuracy::LOW>(double,double,double,double);
+template Vec3 toEuler<TrigAccuracy::MEDIUM>(double,double,double,double);
+template Vec3 toEuler<TrigAccuracy::FULL>(double,double,double,double);
+
+} // end namespace rmath
@@ -0,0 +1,198 @@
+#ifndef SIMDISA_H__
+#define SIMDISA_H__
+
+#include "FastTrig.h"
+
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX__)
+  #include <immintrin.h>
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SimdISA.h
+/// @brief private to the library : thin wrappers around the intrinsics so the batch kernels are written once for every
+/// lane width, the widest instruction set the library is compiled for is picked
+//----------------------------------------------------------------------------------------------------------------------
+namespace rmath
+{
+namespace simd
+{
+
+#if defined(__AVX2__) || defined(__AVX__)
+struct ISA
+{
+  typedef __m256 V;
+  typedef __m256 M;
+  enum { Width=8 };
+#if defined(__AVX2__)
+  static const char *name() { return "AVX2"; }
+#else
+  static const char *name() { return "AVX"; }
+#endif
+  static V load(const float *_p) { return _mm256_loadu_ps(_p); }
+  static void store(float *_p, V _v) { _mm256_storeu_ps(_p,_v); }
+  static V set1(float _f) { return _mm256_set1_ps(_f); }
+  static V add(V _a, V _b) { return _mm256_add_ps(_a,_b); }
+  static V sub(V _a, V _b) { return _mm256_sub_ps(_a,_b); }
+  static V mul(V _a, V _b) { return _mm256_mul_ps(_a,_b); }
+  static V div(V _a, V _b) { return _mm256_div_ps(_a,_b); }
+  static V sqrt(V _a) { return _mm256_sqrt_ps(_a); }
+  static V min(V _a, V _b) { return _mm256_min_ps(_a,_b); }
+  static V max(V _a, V _b) { return _mm256_max_ps(_a,_b); }
+  static V abs(V _a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f),_a); }
+  static V round(V _a) { return _mm256_round_ps(_a,_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+  static V cmpEq(V _a, V _b) { return _mm256_cmp_ps(_a,_b,_CMP_EQ_OQ); }
+  static V cmpLt(V _a, V _b) { return _mm256_cmp_ps(_a,_b,_CMP_LT_OQ); }
+  static V cmpGe(V _a, V _b) { return _mm256_cmp_ps(_a,_b,_CMP_GE_OQ); }
+  static V cmpGt(V _a, V _b) { return _mm256_cmp_ps(_a,_b,_CMP_GT_OQ); }
+  // lanes where _mask is set take _a, the others _b
+  static V select(V _mask, V _a, V _b) { return _mm256_blendv_ps(_b,_a,_mask); }
+  // bit i set when lane i of _mask is
+  static int bits(V _mask) { return _mm256_movemask_ps(_mask); }
+};
+#elif defined(__SSE2__)
+struct ISA
+{
+  typedef __m128 V;
+  typedef __m128 M;
+  enum { Width=4 };
+  static const char *name() { return "SSE"; }
+  static V load(const float *_p) { return _mm_loadu_ps(_p); }
+  static void store(float *_p, V _v) { _mm_storeu_ps(_p,_v); }
+  static V set1(float _f) { return _mm_set1_ps(_f); }
+  static V add(V _a, V _b) { return _mm_add_ps(_a,_b); }
+  static V sub(V _a, V _b) { return _mm_sub_ps(_a,_b); }
+  static V mul(V _a, V _b) { return _mm_mul_ps(_a,_b); }
+  static V div(V _a, V _b) { return _mm_div_ps(_a,_b); }
+  static V sqrt(V _a) { return _mm_sqrt_ps(_a); }
+  static V min(V _a, V _b) { return _mm_min_ps(_a,_b); }
+  static V max(V _a, V _b) { return _mm_max_ps(_a,_b); }
+  static V abs(V _a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f),_a); }
+  // no roundps before SSE4.1, the int conversion rounds to nearest (valid for |_a| < 2^31)
+  static V round(V _a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(_a)); }
+  static V cmpEq(V _a, V _b) { return _mm_cmpeq_ps(_a,_b); }
+  static V cmpLt(V _a, V _b) { return _mm_cmplt_ps(_a,_b); }
+  static V cmpGe(V _a, V _b) { return _mm_cmpge_ps(_a,_b); }
+  static V cmpGt(V _a, V _b) { return _mm_cmpgt_ps(_a,_b); }
+  // no blendv before SSE4.1 so use the and / andnot / or idiom
+  static V select(V _mask, V _a, V _b) { return _mm_or_ps(_mm_and_ps(_mask,_a),_mm_andnot_ps(_mask,_b)); }
+  static int bits(V _mask) { return _mm_movemask_ps(_mask); }
+};
+#else
+struct ISA
+{
+  typedef float V;
+  typedef bool M;
+  enum { Width=1 };
+  static const char *name() { return "scalar"; }
+  static V load(const float *_p) { return *_p; }
+  static void store(float *_p, V _v) { *_p=_v; }
+  static V set1(float _f) { return _f; }
+  static V add(V _a, V _b) { return _a+_b; }
+  static V sub(V _a, V _b) { return _a-_b; }
+  static V mul(V _a, V _b) { return _a*_b; }
+  static V div(V _a, V _b) { return _a/_b; }
+  static V sqrt(V _a) { return std::sqrt(_a); }
+  static V min(V _a, V _b) { return _a<_b ? _a : _b; }
+  static V max(V _a, V _b) { return _a>_b ? _a : _b; }
+  static V abs(V _a) { return std::fabs(_a); }
+  static V round(V _a) { return std::nearbyint(_a); }
+  static bool cmpEq(V _a, V _b) { return _a==_b; }
+  static bool cmpLt(V _a, V _b) { return _a<_b; }
+  static bool cmpGe(V _a, V _b) { return _a>=_b; }
+  static bool cmpGt(V _a, V _b) { return _a>_b; }
+  static V select(bool _mask, V _a, V _b) { return _mask ? _a : _b; }
+  static int bits(bool _mask) { return _mask ? 1 : 0; }
+};
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a register of ISA::Width floats with the arithmetic operators, so the templated kernels in FastTrig.h and
+/// RotationMath.h can be instantiated for a whole register as well as for float / double. The helpers below are
+/// found by argument dependent lookup, they match the scalar overloads in FastTrig.h
+//----------------------------------------------------------------------------------------------------------------------
+struct Float
+{
+  ISA::V m_v;
+
+  Float() {}
+  Float(float _f) : m_v(ISA::set1(_f)) {}
+  static Float raw(ISA::V _v) { Float f; f.m_v=_v; return f; }
+  static Float load(const float *_p) { return raw(ISA::load(_p)); }
+  void store(float *_p) const { ISA::store(_p,m_v); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the result of comparing two Floats, one lane mask per lane
+//----------------------------------------------------------------------------------------------------------------------
+struct Mask
+{
+  ISA::M m_m;
+};
+
+inline Float operator+(Float _a, Float _b) { return Float::raw(ISA::add(_a.m_v,_b.m_v)); }
+inline Float operator-(Float _a, Float _b) { return Float::raw(ISA::sub(_a.m_v,_b.m_v)); }
+inline Float operator*(Float _a, Float _b) { return Float::raw(ISA::mul(_a.m_v,_b.m_v)); }
+inline Float operator/(Float _a, Float _b) { return Float::raw(ISA::div(_a.m_v,_b.m_v)); }
+inline Float operator-(Float _a) { return Float::raw(ISA::sub(ISA::set1(0.0f),_a.m_v)); }
+inline Mask operator<(Float _a, Float _b) { return Mask{ISA::cmpLt(_a.m_v,_b.m_v)}; }
+inline Mask operator>(Float _a, Float _b) { return Mask{ISA::cmpGt(_a.m_v,_b.m_v)}; }
+inline Mask operator>=(Float _a, Float _b) { return Mask{ISA::cmpGe(_a.m_v,_b.m_v)}; }
+inline Mask operator==(Float _a, Float _b) { return Mask{ISA::cmpEq(_a.m_v,_b.m_v)}; }
+inline Float select(Mask _m, Float _a, Float _b) { return Float::raw(ISA::select(_m.m_m,_a.m_v,_b.m_v)); }
+inline Float roundNearest(Float _a) { return Float::raw(ISA::round(_a.m_v)); }
+inline Float absolute(Float _a) { return Float::raw(ISA::abs(_a.m_v)); }
+inline Float squareRoot(Float _a) { return Float::raw(ISA::sqrt(_a.m_v)); }
+inline Float minimum(Float _a, Float _b) { return Float::raw(ISA::min(_a.m_v,_b.m_v)); }
+inline Float maximum(Float _a, Float _b) { return Float::raw(ISA::max(_a.m_v,_b.m_v)); }
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the lanes of _m as the low ISA::Width bits of an int, lane 0 in bit 0
+//----------------------------------------------------------------------------------------------------------------------
+inline int laneBits(Mask _m) { return ISA::bits(_m.m_m); }
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief libm one lane at a time, what FastTrig<TrigAccuracy::FULL> runs on a Float
+//----------------------------------------------------------------------------------------------------------------------
+template<typename F>
+inline Float perLane(Float _a, F _f)
+{
+  float lanes[ISA::Width];
+  _a.store(lanes);
+  for(float &lane : lanes)
+  {
+    lane=_f(lane);
+  }
+  return Float::load(lanes);
+}
+
+inline Float sin(Float _a) { return perLane(_a,[](float _v){ return std::sin(_v); }); }
+inline Float cos(Float _a) { return perLane(_a,[](float _v){ return std::cos(_v); }); }
+// clamped like the FastTrig tiers
+inline Float acos(Float _a) { return perLane(_a,[](float _v){ return std::acos(_v>1.0f ? 1.0f : _v<-1.0f ? -1.0f : _v); }); }
+inline Float asin(Float _a) { return perLane(_a,[](float _v){ return std::asin(_v>1.0f ? 1.0f : _v<-1.0f ? -1.0f : _v); }); }
+inline Float atan2(Float _y, Float _x)
+{
+  float y[ISA::Width];
+  float x[ISA::Width];
+  _y.store(y);
+  _x.store(x);
+  for(int i=0; i<ISA::Width; ++i)
+  {
+    y[i]=std::atan2(y[i],x[i]);
+  }
+  return Float::load(y);
+}
+
+} // end namespace simd
+
+template<>
+struct LaneScalar<simd::Float>
+{
+  typedef float type;
+};
+} // end namespace rmath
+
+#endif
@@ -0,0 +1,216 @@
+#include "TransformStore.h"
+
+namespace rmath
+{
+
+TransformStore::TransformStore()
+{
+  m_firstFree=NO_SLOT;
+}
+
+void TransformStore::reserve(size_t _count)
+{
+  m_slots.reserve(_count);
+  m_slotOf.reserve(_count);
+  for(AlignedFloats *component : components())
+  {
+    component->reserve(_count);
+  }
+}
+
+TransformHandle TransformStore::create(const Vec3 &_position, const Quaternion &_rotation, const Vec3 &_scale)
+{
+  uint32_t index=static_cast<uint32_t>(size());
+  uint32_t slot;
+  if(m_firstFree!=NO_SLOT)
+  {
+    slot=m_firstFree;
+    m_firstFree=m_slots[slot].m_index;
+    m_slots[slot].m_index=index;
+  }
+  else
+  {
+    slot=static_cast<uint32_t>(m_slots.size());
+    m_slots.push_back({index,0});
+  }
+  m_slotOf.push_back(slot);
+  m_positionX.push_back(_position.m_x);
+  m_positionY.push_back(_position.m_y);
+  m_positionZ.push_back(_position.m_z);
+  m_rotationS.push_back(_rotation.m_s);
+  m_rotationX.push_back(_rotation.m_x);
+  m_rotationY.push_back(_rotation.m_y);
+  m_rotationZ.push_back(_rotation.m_z);
+  m_scaleX.push_back(_scale.m_x);
+  m_scaleY.push_back(_scale.m_y);
+  m_scaleZ.push_back(_scale.m_z);
+  m_radius.push_back(0.0f);
+  return {slot,m_slots[slot].m_generation};
+}
+
+void TransformStore::destroy(TransformHandle _handle)
+{
+  if(!isValid(_handle))
+  {
+    return;
+  }
+  Slot &slot=m_slots[_handle.m_slot];
+  uint32_t index=slot.m_index;
+  uint32_t last=static_cast<uint32_t>(size()-1);
+  // the last transform fills the hole so the arrays stay packed
+  if(index!=last)
+  {
+    for(AlignedFloats *component : components())
+    {
+      (*component)[index]=(*component)[last];
+    }
+    m_slotOf[index]=m_slotOf[last];
+    m_slots[m_slotOf[index]].m_index=index;
+  }
+  for(AlignedFloats *component : components())
+  {
+    component->pop_back();
+  }
+  m_slotOf.pop_back();
+  // a new generation so the old handle no longer matches
+  ++slot.m_generation;
+  slot.m_index=m_firstFree;
+  m_firstFree=_handle.m_slot;
+}
+
+bool TransformStore::isValid(TransformHandle _handle) const
+{
+  // freeing a slot bumps its generation so only the live handle matches
+  return _handle.m_slot<m_slots.size() && m_slots[_handle.m_slot].m_generation==_handle.m_generation;
+}
+
+void TransformStore::clear()
+{
+  // every slot goes on the free list with a new generation
+  for(size_t i=0; i<m_slotOf.size(); ++i)
+  {
+    Slot &slot=m_slots[m_slotOf[i]];
+    ++slot.m_generation;
+    slot.m_index=m_firstFree;
+    m_firstFree=m_slotOf[i];
+  }
+  m_slotOf.clear();
+  for(AlignedFloats *component : components())
+  {
+    component->clear();
+  }
+}
+
+TransformHandle TransformStore::handleAt(size_t _index) const
+{
+  uint32_t slot=m_slotOf[_index];
+  return {slot,m_slots[slot].m_generation};
+}
+
+void TransformStore::setPosition(TransformHandle _handle, const Vec3 &_position)
+{
+  size_t i=indexOf(_handle);
+  m_positionX[i]=_position.m_x;
+  m_positionY[i]=_position.m_y;
+  m_positionZ[i]=_position.m_z;
+}
+
+void TransformStore::setRotation(TransformHandle _handle, const Quaternion &_rotation)
+{
+  size_t i=indexOf(_handle);
+  m_rotationS[i]=_rotation.m_s;
+  m_rotationX[i]=_rotation.m_x;
+  m_rotationY[i]=_rotation.m_y;
+  m_rotationZ[i]=_rotation.m_z;
+}
+
+void TransformStore::setScale(TransformHandle _handle, const Vec3 &_scale)
+{
+  size_t i=indexOf(_handle);
+  m_scaleX[i]=_scale.m_x;
+  m_scaleY[i]=_scale.m_y;
+  m_scaleZ[i]=_scale.m_z;
+}
+
+void TransformStore::setBoundingRadius(TransformHandle _handle, float _radius)
+{
+  m_radius[indexOf(_handle)]=_radius;
+}
+
+Vec3 TransformStore::position(TransformHandle _handle) const
+{
+  size_t i=indexOf(_handle);
+  return Vec3(m_positionX[i],m_positionY[i],m_positionZ[i]);
+}
+
+Quaternion TransformStore::rotation(TransformHandle _handle) const
+{
+  size_t i=indexOf(_handle);
+  return Quaternion(m_rotationS[i],m_rotationX[i],m_rotationY[i],m_rotationZ[i]);
+}
+
+Vec3 TransformStore::scale(TransformHandle _handle) const
+{
+  size_t i=indexOf(_handle);
+  return Vec3(m_scaleX[i],m_scaleY[i],m_scaleZ[i]);
+}
+
+PoseStream TransformStore::poses()
+{
+  return {m_positionX.data(),m_positionY.data(),m_positionZ.data(),
+          {m_rotationS.data(),m_rotationX.data(),m_rotationY.data(),m_rotationZ.data()}};
+}
+
+Vec3Stream TransformStore::positions() const
+{
+  return {m_positionX.data(),m_positionY.data(),m_positionZ.data()};
+}
+
+Vec3Stream TransformStore::scales() const
+{
+  return {m_scaleX.data(),m_scaleY.data(),m_scaleZ.data()};
+}
+
+std::array<AlignedFloats *,11> TransformStore::components()
+{
+  return {{&m_positionX,&m_positionY,&m_positionZ,&m_rotationS,&m_rotationX,&m_rotationY,&m_rotationZ,
+           &m_scaleX,&m_scaleY,&m_scaleZ,&m_radius}};
+}
+
+Mat4 TransformStore::worldMatrix(size_t _index) const
+{
+  Mat4 m;
+  worldMatrices(_index,_index+1,&m);
+  return m;
+}
+
+void TransformStore::worldMatrices(size_t _begin, size_t _end, Mat4 *o_out) const
+{
+  const float (*root)[4]=m_root.m_m;
+  for(size_t i=_begin; i<_end; ++i)
+  {
+    // the rows of scale * rotation (toMat4 with each row scaled) then translation, as a 4x3 since the last column
+    // of an affine local transform is (0,0,0,1)
+    Mat4 rotation=toMat4(Quaternion(m_rotationS[i],m_rotationX[i],m_rotationY[i],m_rotationZ[i]));
+    const float scale[3]={m_scaleX[i],m_scaleY[i],m_scaleZ[i]};
+    float local[4][3];
+    for(int r=0; r<3; ++r)
+      for(int c=0; c<3; ++c)
+        local[r][c]=rotation.m_m[r][c]*scale[r];
+    local[3][0]=m_positionX[i];
+    local[3][1]=m_positionY[i];
+    local[3][2]=m_positionZ[i];
+
+    float (*world)[4]=o_out[i-_begin].m_m;
+    for(int c=0; c<4; ++c)
+    {
+      for(int r=0; r<3; ++r)
+      {
+        world[r][c]=local[r][0]*root[0][c]+local[r][1]*root[1][c]+local[r][2]*root[2][c];
+      }
+      world[3][c]=local[3][0]*root[0][c]+local[3][1]*root[1][c]+local[3][2]*root[2][c]+root[3][c];
+    }
+  }
+}
+
+} // end namespace rmath
@@ -0,0 +1,19 @@
+# command line front end to the rotation maths library, streams binary
+# vector pairs in and quaternions / matrices out
+TARGET=rotcli
+TEMPLATE=app
+CONFIG+=console c++11
+CONFIG-=qt app_bundle
+OBJECTS_DIR=obj
+# put the exe in the project root next to the demo
+DESTDIR=$$PWD/..
+SOURCES+= $$PWD/src/*.cpp
+INCLUDEPATH +=$$PWD/../rotationmath/include
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+QMAKE_CXXFLAGS+= -ffp-contract=off
+linux-*:QMAKE_CXXFLAGS +=  -march=native
+win32:DEFINES+=_USE_MATH_DEFINES
+unix:LIBS+= -L$$PWD/../lib -lRotationMath
+unix:PRE_TARGETDEPS+=$$PWD/../lib/libRotationMath.a
+win32:LIBS+= -L$$PWD/../lib -lRotationMath
+win32:PRE_TARGETDEPS+=$$PWD/../lib/RotationMath.lib
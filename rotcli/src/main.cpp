@@ -0,0 +1,185 @@
+/****************************************************************************
+rotcli : stream binary vector pairs through the rotation maths library
+
+input  : native endian float32 records of 6 values, start xyz then dest xyz
+output : per pair either a quaternion (4 float32, s x y z) or a row major
+         rotation matrix (16 float32, same layout as ngl::Mat4)
+****************************************************************************/
+#include "RotationBatch.h"
+#include "RotationMath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <fcntl.h>
+  #include <io.h>
+#endif
+
+namespace
+{
+
+enum class OutputFormat { QUATERNION, MATRIX };
+
+void usage()
+{
+  std::cerr<<"usage : rotcli [-i input] [-o output] [-f quat|mat4] [-b pairsPerBlock]\n"
+           <<"  -i  file of float32 vector pairs (sx sy sz dx dy dz), default stdin\n"
+           <<"  -o  where to write the results, default stdout\n"
+           <<"  -f  quat writes s x y z per pair, mat4 writes a 16 float row major matrix, default quat\n"
+           <<"  -b  number of pairs processed per block, default 65536\n";
+}
+
+} // end anon namespace
+
+int main(int argc, char **argv)
+{
+  std::string inputName;
+  std::string outputName;
+  OutputFormat format=OutputFormat::QUATERNION;
+  size_t blockSize=65536;
+
+  for(int i=1; i<argc; ++i)
+  {
+    std::string arg=argv[i];
+    if(arg=="-h" || arg=="--help")
+    {
+      usage();
+      return EXIT_SUCCESS;
+    }
+    if(i+1>=argc)
+    {
+      usage();
+      return EXIT_FAILURE;
+    }
+    std::string value=argv[++i];
+    if(arg=="-i")
+      inputName=value;
+    else if(arg=="-o")
+      outputName=value;
+    else if(arg=="-f" && value=="quat")
+      format=OutputFormat::QUATERNION;
+    else if(arg=="-f" && value=="mat4")
+      format=OutputFormat::MATRIX;
+    else if(arg=="-b" && std::atol(value.c_str())>0)
+      blockSize=static_cast<size_t>(std::atol(value.c_str()));
+    else
+    {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+#if defined(_WIN32)
+  _setmode(_fileno(stdin),_O_BINARY);
+  _setmode(_fileno(stdout),_O_BINARY);
+#endif
+  FILE *in= inputName.empty() ? stdin : std::fopen(inputName.c_str(),"rb");
+  if(in==nullptr)
+  {
+    std::cerr<<"rotcli : unable to open "<<inputName<<"\n";
+    return EXIT_FAILURE;
+  }
+  FILE *out= outputName.empty() ? stdout : std::fopen(outputName.c_str(),"wb");
+  if(out==nullptr)
+  {
+    std::cerr<<"rotcli : unable to open "<<outputName<<"\n";
+    return EXIT_FAILURE;
+  }
+
+  // interleaved records as read, the de-interleaved streams the batch kernel wants and the packed output
+  std::vector<float> records(blockSize*6);
+  std::vector<float> soa(blockSize*10);
+  const size_t outStride= format==OutputFormat::QUATERNION ? 4 : 16;
+  std::vector<float> results(blockSize*outStride);
+  float *sx=&soa[0];
+  float *sy=sx+blockSize;
+  float *sz=sy+blockSize;
+  float *dx=sz+blockSize;
+  float *dy=dx+blockSize;
+  float *dz=dy+blockSize;
+  float *qs=dz+blockSize;
+  float *qx=qs+blockSize;
+  float *qy=qx+blockSize;
+  float *qz=qy+blockSize;
+
+  const size_t recordBytes=6*sizeof(float);
+  size_t total=0;
+  size_t partialBytes=0;
+  auto start=std::chrono::steady_clock::now();
+  size_t bytes;
+  // read in bytes so a cut off last record is seen rather than dropped by fread, fread only comes back short at the
+  // end of the input or on an error so only the last block can hold one
+  while((bytes=std::fread(&records[0],1,blockSize*recordBytes,in)) > 0)
+  {
+    size_t count=bytes/recordBytes;
+    partialBytes=bytes%recordBytes;
+    for(size_t i=0; i<count; ++i)
+    {
+      const float *r=&records[i*6];
+      sx[i]=r[0]; sy[i]=r[1]; sz[i]=r[2];
+      dx[i]=r[3]; dy[i]=r[4]; dz[i]=r[5];
+    }
+    rmath::rotationBetweenVectorsBatch({sx,sy,sz},{dx,dy,dz},{qs,qx,qy,qz},count);
+
+    if(format==OutputFormat::QUATERNION)
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        float *o=&results[i*4];
+        o[0]=qs[i]; o[1]=qx[i]; o[2]=qy[i]; o[3]=qz[i];
+      }
+    }
+    else
+    {
+      for(size_t i=0; i<count; ++i)
+      {
+        rmath::Mat4 m=rmath::toMat4(rmath::Quaternion(qs[i],qx[i],qy[i],qz[i]));
+        std::memcpy(&results[i*16],&m.m_m[0][0],16*sizeof(float));
+      }
+    }
+    if(std::fwrite(&results[0],outStride*sizeof(float),count,out)!=count)
+    {
+      std::cerr<<"rotcli : write failed\n";
+      return EXIT_FAILURE;
+    }
+    total+=count;
+  }
+  int status=EXIT_SUCCESS;
+  if(std::ferror(in))
+  {
+    std::cerr<<"rotcli : read failed after "<<total<<" pairs\n";
+    status=EXIT_FAILURE;
+  }
+  else if(partialBytes!=0)
+  {
+    std::cerr<<"rotcli : input ends with a partial record of "<<partialBytes<<" bytes after "<<total
+             <<" pairs, records are "<<recordBytes<<" bytes\n";
+    status=EXIT_FAILURE;
+  }
+  // buffered results only reach the file here, a full disk shows up as a failed flush or close
+  if(std::fflush(out)!=0 || std::ferror(out))
+  {
+    std::cerr<<"rotcli : write failed\n";
+    status=EXIT_FAILURE;
+  }
+  auto end=std::chrono::steady_clock::now();
+  double seconds=std::chrono::duration<double>(end-start).count();
+
+  std::cerr<<"rotcli : "<<total<<" pairs in "<<seconds<<"s ("
+           <<(seconds>0.0 ? total/seconds/1.0e6 : 0.0)<<" M pairs/s, "<<rmath::rotationBatchISA()<<")\n";
+
+  if(in!=stdin)
+    std::fclose(in);
+  if(out!=stdout && std::fclose(out)!=0)
+  {
+    std::cerr<<"rotcli : closing "<<outputName<<" failed\n";
+    status=EXIT_FAILURE;
+  }
+  return status;
+}
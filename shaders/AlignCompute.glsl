@@ -0,0 +1,67 @@
+#version 430 core
+/// @brief shortest arc alignment on the GPU, same construction as rmath::rotationBetweenVectorsBatch
+/// reads the selected start / dest pairs and writes them packed front to back as InstanceData (see InstanceData.h)
+layout (local_size_x=64) in;
+
+struct AlignmentPair
+{
+  vec4 start;
+  vec4 dest;
+  vec4 translation;
+};
+
+struct Instance
+{
+  vec4 rotation;
+  vec3 translation;
+  float pad;
+};
+
+layout (std430, binding=0) readonly buffer Pairs
+{
+  AlignmentPair pairs[];
+};
+
+layout (std430, binding=1) buffer Instances
+{
+  Instance instances[];
+};
+
+/// @brief the pair written to each instance, only the visible ones so the draw needs no gaps
+layout (std430, binding=2) readonly buffer Selection
+{
+  uint selection[];
+};
+
+/// @brief the number of selected pairs
+uniform uint count;
+/// @brief when set every pair uses target as its dest
+uniform bool overrideTarget;
+uniform vec3 target;
+
+void main()
+{
+  uint i=gl_GlobalInvocationID.x;
+  if(i >= count)
+  {
+    return;
+  }
+  uint pair=selection[i];
+  vec3 start=normalize(pairs[pair].start.xyz);
+  vec3 dest=normalize(overrideTarget ? target : pairs[pair].dest.xyz);
+  float cosTheta=dot(start,dest);
+
+  // general case, rotate about start x dest
+  float s=sqrt(max((1.0+cosTheta)*2.0,1e-30));
+  vec4 q=vec4(cross(start,dest)/s,s*0.5);
+
+  // antiparallel, 180 degrees about Z x start or Y x start if start is along Z
+  vec3 axis=vec3(-start.y,start.x,0.0);
+  axis= dot(axis.xy,axis.xy)==0.0 ? vec3(start.z,0.0,-start.x) : axis;
+  q= cosTheta < (1e-6 - 1.0) ? vec4(normalize(axis),0.0) : q;
+  // same vectors
+  q= cosTheta >= 1.0 ? vec4(0.0,0.0,0.0,1.0) : q;
+
+  instances[i].rotation=q;
+  instances[i].translation=pairs[pair].translation.xyz;
+}
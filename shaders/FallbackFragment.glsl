@@ -0,0 +1,8 @@
+#version 330 core
+/// @brief our output fragment colour
+layout (location =0)out vec4 fragColour;
+
+void main()
+{
+  fragColour=vec4(0.7,0.7,0.7,1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+/// @brief placeholder drawn while the real programs compile, see ShaderCompileQueue.h
+layout(location =0)in vec3 inVert;
+
+/// @brief per object transforms, see TransformBlock in UniformBlockBuffer.h
+layout(std140) uniform TransformData
+{
+  mat4 M;
+  mat4 MV;
+  mat4 MVP;
+  mat3 normalMatrix;
+};
+
+void main()
+{
+  gl_Position = MVP*vec4(inVert,1.0);
+}
@@ -28,8 +28,13 @@ struct Lights
 //	float quadraticAttenuation;
 //	float linearAttenuation;
 };
-// @param material passed from our program
-uniform Materials material;
+/// @brief every material used by the scene, uploaded once, see MaterialBlock in UniformBlockBuffer.h
+layout(std140) uniform MaterialData
+{
+	Materials materials[8];
+};
+// @param materialIndex the entry of materials used by this draw
+uniform int materialIndex;
 
 uniform Lights light;
 in vec3 lightDir;
@@ -44,6 +49,7 @@ in vec3 vPosition;
 
 vec4 pointLight()
 {
+	Materials material=materials[materialIndex];
 	vec3 N = normalize(fragmentNormal);
 	vec3 halfV;
 	float ndothv;
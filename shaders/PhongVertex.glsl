@@ -1,8 +1,6 @@
 #version 330 core
 /// @brief flag to indicate if model has unit normals if not normalize
 uniform bool Normalize;
-// the eye position of the camera
-uniform vec3 viewerPos;
 /// @brief the current fragment normal for the vert being processed
 out vec3 fragmentNormal;
 /// @brief the vertex passed in
@@ -16,14 +14,12 @@ layout(location =1)in vec2 inUV;
 layout (location=3)in vec3 inColour;
 out vec3 vertColour;
 
-struct Materials
-{
-	vec4 ambient;
-	vec4 diffuse;
-	vec4 specular;
-	float shininess;
-};
-
+/// @brief per instance rotation quaternion (xyz vector part, w scalar), see InstanceData.h
+layout (location=4)in vec4 inInstanceRotation;
+/// @brief per instance translation applied after the rotation
+layout (location=5)in vec3 inInstanceTranslation;
+/// @brief when set the model transform is built from the instance attributes and M is the global transform
+uniform bool instanced;
 
 struct Lights
 {
@@ -36,8 +32,6 @@ struct Lights
 //	float quadraticAttenuation;
 //	float linearAttenuation;
 };
-// our material
-uniform Materials material;
 // array of lights
 uniform Lights light;
 // direction of the lights used for shading
@@ -48,18 +42,44 @@ out vec3 eyeDirection;
 out vec3 vPosition;
 
 
-uniform mat4 MV;
-uniform mat4 MVP;
-uniform mat3 normalMatrix;
-uniform mat4 M;
+/// @brief per frame camera data, see FrameBlock in UniformBlockBuffer.h
+layout(std140) uniform FrameData
+{
+  mat4 V;
+  mat4 VP;
+  // the eye position of the camera
+  vec4 viewerPos;
+};
+
+/// @brief per object transforms, see TransformBlock in UniformBlockBuffer.h
+layout(std140) uniform TransformData
+{
+  mat4 M;
+  mat4 MV;
+  mat4 MVP;
+  mat3 normalMatrix;
+};
 
+/// @brief rotate _v by the unit quaternion _q
+vec3 rotateByQuaternion(vec4 _q, vec3 _v)
+{
+  return _v + 2.0*cross(_q.xyz, cross(_q.xyz,_v) + _q.w*_v);
+}
 
 void main()
 {
     vertColour=inColour;
 
+vec3 position=inVert;
+vec3 normal=inNormal;
+if(instanced == true)
+{
+  position=rotateByQuaternion(inInstanceRotation,inVert)+inInstanceTranslation;
+  normal=rotateByQuaternion(inInstanceRotation,inNormal);
+}
+
 // calculate the fragments surface normal
-fragmentNormal = (normalMatrix*inNormal);
+fragmentNormal = (normalMatrix*normal);
 
 
 if (Normalize == true)
@@ -67,14 +87,14 @@ if (Normalize == true)
  fragmentNormal = normalize(fragmentNormal);
 }
 // calculate the vertex position
-gl_Position = MVP*vec4(inVert,1.0);
+gl_Position = MVP*vec4(position,1.0);
 
-vec4 worldPosition = M * vec4(inVert, 1.0);
-eyeDirection = normalize(viewerPos - worldPosition.xyz);
+vec4 worldPosition = M * vec4(position, 1.0);
+eyeDirection = normalize(viewerPos.xyz - worldPosition.xyz);
 // Get vertex position in eye coordinates
 // Transform the vertex to eye co-ordinates for frag shader
 /// @brief the vertex in eye co-ordinates  homogeneous
-vec4 eyeCord=MV*vec4(inVert,1);
+vec4 eyeCord=MV*vec4(position,1);
 
 vPosition = eyeCord.xyz / eyeCord.w;;
 
@@ -0,0 +1,111 @@
+#include "DrawQueue.h"
+
+#include <cstring>
+
+DrawQueue::DrawQueue()
+{
+  m_stats={0,0,0};
+}
+
+void DrawQueue::reserve(size_t _count)
+{
+  m_items.reserve(_count);
+  m_scratch.reserve(_count);
+}
+
+uint64_t DrawQueue::makeKey(uint32_t _program, uint32_t _material, uint32_t _mesh, float _depth)
+{
+  // flip the sign bit of positive floats and every bit of negative ones so the bits sort as unsigned integers in the
+  // same order as the floats
+  uint32_t depth;
+  std::memcpy(&depth,&_depth,sizeof(depth));
+  depth^= (depth&0x80000000u) ? 0xffffffffu : 0x80000000u;
+  return (static_cast<uint64_t>(_program&((1u<<PROGRAM_BITS)-1))<<(64-PROGRAM_BITS)) |
+         (static_cast<uint64_t>(_material&((1u<<MATERIAL_BITS)-1))<<(MESH_BITS+DEPTH_BITS)) |
+         (static_cast<uint64_t>(_mesh&((1u<<MESH_BITS)-1))<<DEPTH_BITS) |
+         depth;
+}
+
+void DrawQueue::push(uint32_t _program, uint32_t _material, uint32_t _mesh, float _depth, uint32_t _transform,
+                     uint32_t _instances)
+{
+  m_items.push_back({makeKey(_program,_material,_mesh,_depth),_transform,_instances});
+}
+
+void DrawQueue::sort()
+{
+  const size_t count=m_items.size();
+  if(count<2)
+  {
+    return;
+  }
+  // every byte's histogram in one read of the keys
+  size_t histogram[8][256]={};
+  for(const Item &item : m_items)
+  {
+    for(int byte=0; byte<8; ++byte)
+    {
+      ++histogram[byte][(item.m_key>>(byte*8))&0xff];
+    }
+  }
+  m_scratch.resize(count);
+  for(int byte=0; byte<8; ++byte)
+  {
+    size_t *buckets=histogram[byte];
+    // a byte every key shares would only copy the items across unchanged
+    if(buckets[(m_items[0].m_key>>(byte*8))&0xff]==count)
+    {
+      continue;
+    }
+    size_t offset=0;
+    for(int b=0; b<256; ++b)
+    {
+      size_t inBucket=buckets[b];
+      buckets[b]=offset;
+      offset+=inBucket;
+    }
+    for(const Item &item : m_items)
+    {
+      m_scratch[buckets[(item.m_key>>(byte*8))&0xff]++]=item;
+    }
+    m_items.swap(m_scratch);
+  }
+}
+
+const DrawQueue::Stats &DrawQueue::submit(const Backend &_backend)
+{
+  m_stats={m_items.size(),0,0};
+  bool first=true;
+  uint32_t program=0;
+  uint32_t material=0;
+  uint32_t mesh=0;
+  for(const Item &item : m_items)
+  {
+    uint32_t itemProgram=programOf(item.m_key);
+    uint32_t itemMaterial=materialOf(item.m_key);
+    uint32_t itemMesh=meshOf(item.m_key);
+    bool programChanged= first || itemProgram!=program;
+    if(programChanged)
+    {
+      _backend.m_useProgram(itemProgram);
+      program=itemProgram;
+      ++m_stats.m_stateChanges;
+    }
+    if(programChanged || itemMaterial!=material)
+    {
+      _backend.m_useMaterial(itemMaterial);
+      material=itemMaterial;
+      ++m_stats.m_stateChanges;
+    }
+    if(first || itemMesh!=mesh)
+    {
+      _backend.m_bindMesh(itemMesh);
+      mesh=itemMesh;
+      ++m_stats.m_stateChanges;
+    }
+    first=false;
+    _backend.m_draw(item);
+  }
+  m_stats.m_skipped=3*m_stats.m_draws-m_stats.m_stateChanges;
+  return m_stats;
+}
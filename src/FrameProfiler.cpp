@@ -0,0 +1,201 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the stats are recomputed every this many frames, often enough for a HUD
+//----------------------------------------------------------------------------------------------------------------------
+const static uint32_t STATS_INTERVAL=15;
+
+FrameProfiler::FrameProfiler(size_t _historyFrames)
+{
+  m_history.resize(std::max<size_t>(_historyFrames,1));
+  m_scratch.reserve(m_history.size());
+  m_frame=0;
+  m_framesRecorded=0;
+  for(int i=0; i<2; ++i)
+  {
+    m_queries[i]=0;
+    m_queryFrame[i]=0;
+    m_queryPending[i]=false;
+  }
+  Stats empty={0.0,0.0,0};
+  m_cpuStats=empty;
+  m_gpuStats=empty;
+  std::fill(m_sectionStats,m_sectionStats+SECTIONCOUNT,empty);
+}
+
+FrameProfiler::~FrameProfiler()
+{
+  if(m_queries[0]!=0)
+  {
+    glDeleteQueries(2,m_queries);
+  }
+}
+
+void FrameProfiler::initGL()
+{
+  glGenQueries(2,m_queries);
+}
+
+const char *FrameProfiler::sectionName(Section _section)
+{
+  static const char *names[SECTIONCOUNT]={"matrices","cull","uploads","instances","sort","draw"};
+  return names[_section];
+}
+
+void FrameProfiler::beginFrame()
+{
+  FrameTiming &timing=m_history[m_frame%m_history.size()];
+  timing.m_frame=m_frame;
+  timing.m_cpuMs=0.0f;
+  timing.m_gpuMs=-1.0f;
+  std::fill(timing.m_sectionMs,timing.m_sectionMs+SECTIONCOUNT,0.0f);
+
+  // the query for this slot was issued two frames ago, take the result if it is there, otherwise give up on it
+  int query=m_frame&1;
+  if(m_queries[query]!=0)
+  {
+    collectGPUResult(query);
+    glBeginQuery(GL_TIME_ELAPSED,m_queries[query]);
+    m_queryFrame[query]=m_frame;
+    m_queryPending[query]=true;
+  }
+  // the other slot was last frame, often already done
+  collectGPUResult(query^1);
+  m_frameStart=std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+  if(m_queries[0]!=0)
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+  }
+  FrameTiming &timing=m_history[m_frame%m_history.size()];
+  timing.m_cpuMs=std::chrono::duration<float,std::milli>(std::chrono::steady_clock::now()-m_frameStart).count();
+  ++m_frame;
+  m_framesRecorded=std::min(m_framesRecorded+1,m_history.size());
+  if(m_frame%STATS_INTERVAL==0)
+  {
+    updateStats();
+  }
+}
+
+void FrameProfiler::addSectionTime(Section _section, std::chrono::steady_clock::duration _time)
+{
+  m_history[m_frame%m_history.size()].m_sectionMs[_section]+=std::chrono::duration<float,std::milli>(_time).count();
+}
+
+void FrameProfiler::collectGPUResult(int _query)
+{
+  if(!m_queryPending[_query])
+  {
+    return;
+  }
+  GLint available=0;
+  glGetQueryObjectiv(m_queries[_query],GL_QUERY_RESULT_AVAILABLE,&available);
+  if(available==0 && m_queryFrame[_query]+1==m_frame)
+  {
+    // last frame's query, leave it for next time
+    return;
+  }
+  m_queryPending[_query]=false;
+  if(available==0)
+  {
+    return;
+  }
+  GLuint64 elapsed=0;
+  glGetQueryObjectui64v(m_queries[_query],GL_QUERY_RESULT,&elapsed);
+  FrameTiming &timing=m_history[m_queryFrame[_query]%m_history.size()];
+  if(timing.m_frame==m_queryFrame[_query])
+  {
+    timing.m_gpuMs=static_cast<float>(elapsed/1.0e6);
+  }
+}
+
+FrameProfiler::Stats FrameProfiler::statsFromScratch(size_t _count) const
+{
+  Stats stats={0.0,0.0,_count};
+  if(_count==0)
+  {
+    return stats;
+  }
+  double sum=0.0;
+  for(size_t i=0; i<_count; ++i)
+  {
+    sum+=m_scratch[i];
+  }
+  stats.m_mean=sum/_count;
+  size_t rank=std::min(_count-1,static_cast<size_t>(_count*0.99));
+  std::nth_element(m_scratch.begin(),m_scratch.begin()+rank,m_scratch.begin()+_count);
+  stats.m_p99=m_scratch[rank];
+  return stats;
+}
+
+FrameProfiler::Stats FrameProfiler::computeStats(float FrameTiming::*_field) const
+{
+  m_scratch.clear();
+  for(size_t i=0; i<m_framesRecorded; ++i)
+  {
+    float value=m_history[i].*_field;
+    if(value>=0.0f)
+    {
+      m_scratch.push_back(value);
+    }
+  }
+  return statsFromScratch(m_scratch.size());
+}
+
+FrameProfiler::Stats FrameProfiler::computeSectionStats(Section _section) const
+{
+  m_scratch.clear();
+  for(size_t i=0; i<m_framesRecorded; ++i)
+  {
+    m_scratch.push_back(m_history[i].m_sectionMs[_section]);
+  }
+  return statsFromScratch(m_scratch.size());
+}
+
+void FrameProfiler::updateStats()
+{
+  m_cpuStats=computeStats(&FrameTiming::m_cpuMs);
+  m_gpuStats=computeStats(&FrameTiming::m_gpuMs);
+  for(int s=0; s<SECTIONCOUNT; ++s)
+  {
+    m_sectionStats[s]=computeSectionStats(static_cast<Section>(s));
+  }
+}
+
+bool FrameProfiler::writeCSV(const std::string &_path) const
+{
+  std::ofstream file(_path);
+  if(!file.is_open())
+  {
+    return false;
+  }
+  file<<"frame,cpuMs,gpuMs";
+  for(int s=0; s<SECTIONCOUNT; ++s)
+  {
+    file<<","<<sectionName(static_cast<Section>(s))<<"Ms";
+  }
+  file<<"\n";
+  // oldest first, the current frame is still being filled so stop before it
+  uint32_t first=m_frame-static_cast<uint32_t>(m_framesRecorded);
+  for(uint32_t frame=first; frame!=m_frame; ++frame)
+  {
+    const FrameTiming &timing=m_history[frame%m_history.size()];
+    file<<timing.m_frame<<","<<timing.m_cpuMs<<",";
+    if(timing.m_gpuMs>=0.0f)
+    {
+      file<<timing.m_gpuMs;
+    }
+    for(int s=0; s<SECTIONCOUNT; ++s)
+    {
+      file<<","<<timing.m_sectionMs[s];
+    }
+    file<<"\n";
+  }
+  return file.good();
+}
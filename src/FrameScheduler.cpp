@@ -0,0 +1,68 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+FrameScheduler::FrameScheduler(int _stepMs, int _maxStepsPerFrame)
+{
+  m_stepMs=_stepMs;
+  m_stepNs=static_cast<qint64>(_stepMs)*1000000;
+  m_maxStepsPerFrame=_maxStepsPerFrame;
+  m_lastNs=0;
+  m_accumulatorNs=0;
+  m_fixedSteps=0;
+  m_paused=false;
+}
+
+void FrameScheduler::start()
+{
+  m_clock.start();
+  m_lastNs=0;
+  m_accumulatorNs=0;
+}
+
+int FrameScheduler::advance()
+{
+  qint64 now=m_clock.nsecsElapsed();
+  qint64 delta=now-m_lastNs;
+  m_lastNs=now;
+  if(m_paused)
+  {
+    return 0;
+  }
+  if(m_fixedSteps>0)
+  {
+    return m_fixedSteps;
+  }
+  m_accumulatorNs+=delta;
+  int steps=static_cast<int>(m_accumulatorNs/m_stepNs);
+  m_accumulatorNs-=steps*m_stepNs;
+  if(steps>m_maxStepsPerFrame)
+  {
+    // drop the backlog rather than fast forwarding through it
+    steps=m_maxStepsPerFrame;
+  }
+  return steps;
+}
+
+int FrameScheduler::msUntilNextStep() const
+{
+  if(m_paused)
+  {
+    return -1;
+  }
+  qint64 pending=m_accumulatorNs+(m_clock.nsecsElapsed()-m_lastNs);
+  qint64 remaining=std::max<qint64>(0,m_stepNs-pending);
+  // round up so the timer never fires just before the step is due
+  return static_cast<int>((remaining+999999)/1000000);
+}
+
+void FrameScheduler::setPaused(bool _paused)
+{
+  if(m_paused==_paused)
+  {
+    return;
+  }
+  m_paused=_paused;
+  // time spent paused is not banked
+  m_lastNs=m_clock.nsecsElapsed();
+}
@@ -0,0 +1,185 @@
+#include "GPUAligner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief must match local_size_x in AlignCompute.glsl
+//----------------------------------------------------------------------------------------------------------------------
+const static GLuint WORKGROUP_SIZE=64;
+
+GPUAligner::GPUAligner()
+{
+  m_program=0;
+  m_pairBuffer=0;
+  m_selectionBuffer=0;
+  m_selectedCount=0;
+  m_instanceBuffer=0;
+  m_count=0;
+  m_countLocation=-1;
+  m_overrideTargetLocation=-1;
+  m_targetLocation=-1;
+}
+
+GPUAligner::~GPUAligner()
+{
+  if(m_program!=0)
+  {
+    glDeleteProgram(m_program);
+  }
+  if(m_pairBuffer!=0)
+  {
+    glDeleteBuffers(1,&m_pairBuffer);
+  }
+  if(m_selectionBuffer!=0)
+  {
+    glDeleteBuffers(1,&m_selectionBuffer);
+  }
+}
+
+bool GPUAligner::init(const std::string &_shaderPath, GLuint _instanceBuffer,
+                      const std::vector<ngl::Vec3> &_starts, const std::vector<ngl::Vec3> &_dests,
+                      const std::vector<ngl::Vec3> &_translations)
+{
+  GLint major=0;
+  GLint minor=0;
+  glGetIntegerv(GL_MAJOR_VERSION,&major);
+  glGetIntegerv(GL_MINOR_VERSION,&minor);
+  if(major<4 || (major==4 && minor<3))
+  {
+    std::cerr<<"GPUAligner : compute shaders need GL 4.3, context is "<<major<<"."<<minor<<" using the CPU path\n";
+    return false;
+  }
+
+  std::ifstream file(_shaderPath.c_str());
+  if(!file.is_open())
+  {
+    std::cerr<<"GPUAligner : unable to open "<<_shaderPath<<"\n";
+    return false;
+  }
+  std::stringstream source;
+  source<<file.rdbuf();
+  std::string text=source.str();
+  const char *ptr=text.c_str();
+
+  GLuint shader=glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(shader,1,&ptr,nullptr);
+  glCompileShader(shader);
+  GLint status=GL_FALSE;
+  glGetShaderiv(shader,GL_COMPILE_STATUS,&status);
+  if(status!=GL_TRUE)
+  {
+    char log[4096];
+    glGetShaderInfoLog(shader,sizeof(log),nullptr,log);
+    std::cerr<<"GPUAligner : compile failed "<<_shaderPath<<"\n"<<log<<"\n";
+    glDeleteShader(shader);
+    return false;
+  }
+  GLuint program=glCreateProgram();
+  glAttachShader(program,shader);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+  glGetProgramiv(program,GL_LINK_STATUS,&status);
+  if(status!=GL_TRUE)
+  {
+    char log[4096];
+    glGetProgramInfoLog(program,sizeof(log),nullptr,log);
+    std::cerr<<"GPUAligner : link failed "<<_shaderPath<<"\n"<<log<<"\n";
+    glDeleteProgram(program);
+    return false;
+  }
+  m_program=program;
+  m_countLocation=glGetUniformLocation(m_program,"count");
+  m_overrideTargetLocation=glGetUniformLocation(m_program,"overrideTarget");
+  m_targetLocation=glGetUniformLocation(m_program,"target");
+
+  m_instanceBuffer=_instanceBuffer;
+  glGenBuffers(1,&m_pairBuffer);
+  glGenBuffers(1,&m_selectionBuffer);
+  setPairs(_starts,_dests,_translations);
+  return true;
+}
+
+void GPUAligner::setPairs(const std::vector<ngl::Vec3> &_starts, const std::vector<ngl::Vec3> &_dests,
+                          const std::vector<ngl::Vec3> &_translations)
+{
+  m_count=static_cast<GLuint>(std::min(std::min(_starts.size(),_dests.size()),_translations.size()));
+  // std430 start / dest / translation padded to vec4
+  std::vector<GLfloat> pairs(m_count*12,0.0f);
+  for(GLuint i=0; i<m_count; ++i)
+  {
+    GLfloat *p=&pairs[i*12];
+    p[0]=_starts[i].m_x;
+    p[1]=_starts[i].m_y;
+    p[2]=_starts[i].m_z;
+    p[4]=_dests[i].m_x;
+    p[5]=_dests[i].m_y;
+    p[6]=_dests[i].m_z;
+    p[8]=_translations[i].m_x;
+    p[9]=_translations[i].m_y;
+    p[10]=_translations[i].m_z;
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,m_pairBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,pairs.size()*sizeof(GLfloat),pairs.empty() ? nullptr : &pairs[0],GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,0);
+  // every pair in order until told otherwise
+  std::vector<uint32_t> all(m_count);
+  for(GLuint i=0; i<m_count; ++i)
+  {
+    all[i]=i;
+  }
+  select(all.empty() ? nullptr : &all[0],all.size(),0);
+}
+
+void GPUAligner::select(const uint32_t *_pairs, size_t _count, uint32_t _base)
+{
+  m_selectedCount=static_cast<GLuint>(std::min(_count,static_cast<size_t>(m_count)));
+  std::vector<GLuint> selection(m_selectedCount);
+  for(GLuint i=0; i<m_selectedCount; ++i)
+  {
+    selection[i]=_pairs[i]-_base;
+  }
+  // a new store each time, the last dispatch may still be reading the old
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,m_selectionBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,selection.size()*sizeof(GLuint),
+               selection.empty() ? nullptr : &selection[0],GL_STREAM_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER,0);
+}
+
+void GPUAligner::dispatch()
+{
+  dispatch(false,ngl::Vec3());
+}
+
+void GPUAligner::dispatch(const ngl::Vec3 &_target)
+{
+  dispatch(true,_target);
+}
+
+void GPUAligner::dispatch(bool _overrideTarget, const ngl::Vec3 &_target)
+{
+  if(m_program==0 || m_selectedCount==0)
+  {
+    return;
+  }
+  GLint currentProgram=0;
+  glGetIntegerv(GL_CURRENT_PROGRAM,&currentProgram);
+
+  glUseProgram(m_program);
+  glUniform1ui(m_countLocation,m_selectedCount);
+  glUniform1i(m_overrideTargetLocation,_overrideTarget);
+  glUniform3f(m_targetLocation,_target.m_x,_target.m_y,_target.m_z);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,0,m_pairBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,1,m_instanceBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,2,m_selectionBuffer);
+  glDispatchCompute((m_selectedCount+WORKGROUP_SIZE-1)/WORKGROUP_SIZE,1,1);
+  // the instanced draw reads the results as vertex attributes
+  glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,0,0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,1,0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER,2,0);
+
+  glUseProgram(static_cast<GLuint>(currentProgram));
+}
@@ -0,0 +1,123 @@
+#include "InputLog.h"
+
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief file header, magic then version
+//----------------------------------------------------------------------------------------------------------------------
+const static char INPUT_MAGIC[4]={'R','I','N','P'};
+const static uint32_t INPUT_VERSION=2;
+
+InputRecorder::InputRecorder()
+{
+  m_file=nullptr;
+}
+
+InputRecorder::~InputRecorder()
+{
+  if(m_file!=nullptr)
+  {
+    std::fclose(m_file);
+  }
+}
+
+bool InputRecorder::start(const std::string &_path)
+{
+  if(m_file!=nullptr)
+  {
+    return true;
+  }
+  m_file=std::fopen(_path.c_str(),"wb");
+  if(m_file==nullptr)
+  {
+    std::cerr<<"InputRecorder : unable to open "<<_path<<"\n";
+    return false;
+  }
+  std::fwrite(INPUT_MAGIC,1,sizeof(INPUT_MAGIC),m_file);
+  std::fwrite(&INPUT_VERSION,sizeof(INPUT_VERSION),1,m_file);
+  return true;
+}
+
+void InputRecorder::stop(uint32_t _frame)
+{
+  if(m_file==nullptr)
+  {
+    return;
+  }
+  record(InputEventType::END,_frame);
+  std::fclose(m_file);
+  m_file=nullptr;
+}
+
+void InputRecorder::record(InputEventType _type, uint32_t _frame, int _button, int _x, int _y)
+{
+  if(m_file==nullptr)
+  {
+    return;
+  }
+  InputEvent event;
+  event.m_frame=_frame;
+  event.m_type=_type;
+  event.m_button=static_cast<uint8_t>(_button);
+  event.m_pad=0;
+  event.m_x=_x;
+  event.m_y=_y;
+  // stdio buffers these, input is a handful of events a frame at most
+  std::fwrite(&event,sizeof(InputEvent),1,m_file);
+}
+
+InputReplayer::InputReplayer()
+{
+  m_next=0;
+  m_active=false;
+}
+
+bool InputReplayer::load(const std::string &_path)
+{
+  std::FILE *file=std::fopen(_path.c_str(),"rb");
+  if(file==nullptr)
+  {
+    std::cerr<<"InputReplayer : unable to open "<<_path<<"\n";
+    return false;
+  }
+  char magic[4];
+  uint32_t version=0;
+  if(std::fread(magic,1,sizeof(magic),file)!=sizeof(magic) || std::memcmp(magic,INPUT_MAGIC,sizeof(magic))!=0 ||
+     std::fread(&version,sizeof(version),1,file)!=1 || version!=INPUT_VERSION)
+  {
+    std::cerr<<"InputReplayer : "<<_path<<" is not an input recording\n";
+    std::fclose(file);
+    return false;
+  }
+  m_events.clear();
+  InputEvent event;
+  while(std::fread(&event,sizeof(InputEvent),1,file)==1)
+  {
+    m_events.push_back(event);
+  }
+  std::fclose(file);
+  m_next=0;
+  m_active=true;
+  return true;
+}
+
+const InputEvent *InputReplayer::next(uint32_t _frame)
+{
+  if(m_next==m_events.size() || m_events[m_next].m_frame>_frame)
+  {
+    return nullptr;
+  }
+  return &m_events[m_next++];
+}
+
+uint32_t InputReplayer::frameCount() const
+{
+  if(m_events.empty())
+  {
+    return 0;
+  }
+  // END is tagged with the frame that would have been drawn next
+  const InputEvent &last=m_events.back();
+  return last.m_type==InputEventType::END ? last.m_frame : last.m_frame+1;
+}
@@ -0,0 +1,123 @@
+#include "MeshRegistry.h"
+#include "Tracer.h"
+
+#include <ngl/VAOFactory.h>
+#include <ngl/SimpleIndexVAO.h>
+#include <cstring>
+#include <iostream>
+
+MeshRegistry::~MeshRegistry()
+{
+  clear();
+}
+
+static uint64_t fnv1a(uint64_t _hash, const void *_data, size_t _size)
+{
+  const unsigned char *bytes=static_cast<const unsigned char *>(_data);
+  for(size_t i=0; i<_size; ++i)
+  {
+    _hash^=bytes[i];
+    _hash*=1099511628211ULL;
+  }
+  return _hash;
+}
+
+uint64_t MeshRegistry::hash(const MeshData &_data)
+{
+  uint64_t h=14695981039346656037ULL;
+  uint64_t count=_data.m_vertices.size();
+  h=fnv1a(h,&count,sizeof(count));
+  if(count!=0)
+  {
+    h=fnv1a(h,&_data.m_vertices[0],count*sizeof(MeshVertex));
+  }
+  if(!_data.m_indices.empty())
+  {
+    h=fnv1a(h,&_data.m_indices[0],_data.m_indices.size()*sizeof(GLushort));
+  }
+  return h;
+}
+
+bool MeshRegistry::sameContents(const MeshData &_a, const MeshData &_b)
+{
+  if(_a.m_vertices.size()!=_b.m_vertices.size() || _a.m_indices.size()!=_b.m_indices.size())
+  {
+    return false;
+  }
+  return (_a.m_vertices.empty() ||
+          std::memcmp(&_a.m_vertices[0],&_b.m_vertices[0],_a.m_vertices.size()*sizeof(MeshVertex))==0) &&
+         (_a.m_indices.empty() ||
+          std::memcmp(&_a.m_indices[0],&_b.m_indices[0],_a.m_indices.size()*sizeof(GLushort))==0);
+}
+
+const MeshRegistry::Mesh *MeshRegistry::acquire(const std::string &_name, const std::function<MeshData()> &_build)
+{
+  auto named=m_byName.find(_name);
+  if(named!=m_byName.end())
+  {
+    return named->second;
+  }
+
+  MeshData data=_build();
+  if(data.m_vertices.empty() || data.m_indices.empty())
+  {
+    std::cerr<<"MeshRegistry : "<<_name<<" has "<<data.m_vertices.size()<<" vertices and "<<data.m_indices.size()
+             <<" indices, not uploaded\n";
+    return nullptr;
+  }
+  uint64_t key=hash(data);
+  auto candidates=m_byHash.equal_range(key);
+  for(auto existing=candidates.first; existing!=candidates.second; ++existing)
+  {
+    if(sameContents(existing->second->m_data,data))
+    {
+      // same contents under another name, share it
+      m_byName[_name]=existing->second.get();
+      return existing->second.get();
+    }
+  }
+
+  std::unique_ptr<Mesh> mesh(new Mesh);
+  mesh->m_hash=key;
+  mesh->m_id=static_cast<uint32_t>(m_byId.size());
+  mesh->m_indexCount=static_cast<GLsizei>(data.m_indices.size());
+  const size_t vertexBytes=data.m_vertices.size()*sizeof(MeshVertex);
+  const size_t indexBytes=data.m_indices.size()*sizeof(GLushort);
+  mesh->m_vao.reset(ngl::VAOFactory::createVAO(ngl::simpleIndexVAO,GL_TRIANGLES));
+  mesh->m_vao->bind();
+  // one interleaved vertex buffer plus the element buffer
+  // ngl sizes the element buffer as the index count times the size of the index type, so it wants the count here
+  mesh->m_vao->setData(ngl::SimpleIndexVAO::VertexData(vertexBytes,data.m_vertices[0].m_position[0],
+                                                       data.m_indices.size(),&data.m_indices[0],GL_UNSIGNED_SHORT,
+                                                       GL_STATIC_DRAW));
+  // attribute 0 matches inVert in the shader, attribute 2 inNormal, the offsets are in floats
+  mesh->m_vao->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(MeshVertex),0);
+  mesh->m_vao->setVertexAttributePointer(2,3,GL_FLOAT,sizeof(MeshVertex),3);
+  mesh->m_vao->setNumIndices(mesh->m_indexCount);
+  mesh->m_vao->unbind();
+  Tracer::instance().record(TraceEventType::BUFFERUPLOAD,0,vertexBytes+indexBytes,data.m_vertices.size());
+  mesh->m_data=std::move(data);
+
+  Mesh *result=mesh.get();
+  m_byHash.emplace(key,std::move(mesh));
+  m_byName[_name]=result;
+  m_byId.push_back(result);
+  return result;
+}
+
+const MeshRegistry::Mesh *MeshRegistry::find(const std::string &_name) const
+{
+  auto named=m_byName.find(_name);
+  return named!=m_byName.end() ? named->second : nullptr;
+}
+
+void MeshRegistry::clear()
+{
+  for(auto &mesh : m_byHash)
+  {
+    mesh.second->m_vao->removeVAO();
+  }
+  m_byHash.clear();
+  m_byName.clear();
+  m_byId.clear();
+}
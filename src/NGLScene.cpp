@@ -1,7 +1,14 @@
 #include <QMouseEvent>
 #include <QGuiApplication>
+#include <QStandardPaths>
 
 #include "NGLScene.h"
+#include "RotationMathNGL.h"
+#include "RotationBatch.h"
+#include "Animation.h"
+#include "FrustumCull.h"
+#include "Tracer.h"
+#include "CubeMesh.h"
 #include <ngl/Camera.h>
 #include <ngl/Light.h>
 #include <ngl/Transformation.h>
@@ -19,6 +26,7 @@
 #include <iostream>
 #include <algorithm>
 #include <array>
+#include <cstddef>
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -29,6 +37,25 @@ const static float INCREMENT=0.01;
 /// @brief the increment for the wheel zoom
 //----------------------------------------------------------------------------------------------------------------------
 const static float ZOOM=1;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the instanced cubes are laid out on an INSTANCE_GRID x INSTANCE_GRID grid
+//----------------------------------------------------------------------------------------------------------------------
+const static int INSTANCE_GRID=64;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief distance between neighbouring instances
+//----------------------------------------------------------------------------------------------------------------------
+const static float INSTANCE_SPACING=3.0f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief entries of the material table, see buildMaterials
+//----------------------------------------------------------------------------------------------------------------------
+enum SceneMaterial : GLint
+{
+  PEWTER_MATERIAL=0,
+  BRONZE_MATERIAL,
+  GOLD_MATERIAL,
+  MATERIAL_COUNT
+};
+static_assert(MATERIAL_COUNT<=MAX_MATERIALS,"the material table does not fit the MaterialData block");
 
 NGLScene::NGLScene()
 {
@@ -38,27 +65,105 @@ NGLScene::NGLScene()
   m_spinXFace=0;
   m_spinYFace=0;
   setTitle("Qt5 Simple NGL Demo");
-
-  m_sphereUpdateTimer=startTimer(0);
-  currentTime.start();
+  m_vao=nullptr;
+  m_vao2=nullptr;
+  m_cubeMesh=0;
+  m_drawInstanced=false;
+  m_instanceBuffer=0;
+  m_alignOnGPU=false;
+  m_instancedLocation=-1;
+  m_frameNumber=0;
+  m_showHUD=true;
+  m_phongReady=false;
+  m_materialIndexLocation=-1;
+  m_animationStep=0;
+  // nothing has been built yet
+  m_cameraDirty=true;
+  m_mouseTXDirty=true;
+  m_animationDirty=true;
+  m_alignmentDirty=true;
+  m_repackDirty=true;
+  m_cullDirty=true;
+  std::fill(std::begin(m_objectDirty),std::end(m_objectDirty),true);
+  std::fill(std::begin(m_objectVisible),std::end(m_objectVisible),true);
+  m_visibleCount=0;
+  m_firstVisibleInstance=0;
+  m_instanceDrawCount=0;
+  // every transform the scene will hold is reserved up front so spawning never reallocates
+  m_transforms.reserve(OBJECT_COUNT+INSTANCE_GRID*INSTANCE_GRID);
+  for(rmath::TransformHandle &handle : m_objectTransform)
+  {
+    handle=m_transforms.create();
+    m_transforms.setBoundingRadius(handle,CUBE_BOUNDING_RADIUS);
+  }
+  m_firstInstance=0;
+  m_drawQueue.reserve(OBJECT_COUNT);
+  m_drawBackend.m_useProgram=[this](uint32_t _program)
+  {
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+    (*shader)[_program==FALLBACK_PROGRAM ? "Fallback" : "Phong"]->use();
+    if(_program!=FALLBACK_PROGRAM)
+    {
+      // the demo pair use the uniform model matrices, the instances their per instance transforms
+      glUniform1i(m_instancedLocation,_program==PHONG_INSTANCED_PROGRAM ? 1 : 0);
+    }
+  };
+  m_drawBackend.m_useMaterial=[this](uint32_t _material)
+  {
+    useMaterial(static_cast<GLint>(_material));
+  };
+  m_drawBackend.m_bindMesh=[this](uint32_t _mesh)
+  {
+    m_meshes.mesh(_mesh).m_vao->bind();
+  };
+  m_drawBackend.m_draw=[this](const DrawQueue::Item &_item)
+  {
+    m_transformBlocks.bind(_item.m_transform);
+    GLsizei indices=m_meshes.mesh(DrawQueue::meshOf(_item.m_key)).m_indexCount;
+    if(_item.m_instances!=0)
+    {
+      glDrawElementsInstanced(GL_TRIANGLES,indices,GL_UNSIGNED_SHORT,nullptr,static_cast<GLsizei>(_item.m_instances));
+    }
+    else
+    {
+      glDrawElements(GL_TRIANGLES,indices,GL_UNSIGNED_SHORT,nullptr);
+    }
+  };
+
+  // redraws are paced by the buffer swap (vsync) and only requested when the animation has a step due
+  m_stepTimer.setSingleShot(true);
+  m_stepTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_stepTimer,&QTimer::timeout,[this](){ update(); });
+  connect(this,&QOpenGLWindow::frameSwapped,[this](){ scheduleNextFrame(); });
+  m_scheduler.start();
 }
 
 
 NGLScene::~NGLScene()
 {
+  // the window's context is not guaranteed to be current once app.exec() has returned, and the GL owning members
+  // (stream, uniform blocks, profiler queries, aligner, compile queue) are destroyed after this body against whatever
+  // is current. A window that was never shown (OffscreenRunner) has no context of its own and makeCurrent leaves the
+  // runner's current
+  makeCurrent();
   std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
+  m_inputRecorder.stop(m_frameNumber);
 
-
-  m_vao->removeVAO();
-  m_vao2->removeVAO();
+  m_meshes.clear();
+  glDeleteBuffers(1,&m_instanceBuffer);
 }
 
 void NGLScene::resizeGL(int _w, int _h)
 {
   // set the viewport for openGL
   glViewport(0,0,_w,_h);
-  // now set the camera size values as the screen size has changed
-  m_cam->setShape(45,(float)_w/_h,0.05,350);
+  if(m_text)
+  {
+    m_text->setScreenSize(_w,_h);
+  }
+  // the camera shape changes what is culled so it is recorded like input, a replay keeps the recorded shape whatever
+  // size its own window is
+  handleInput(InputEventType::RESIZE,0,_w,_h);
   update();
 }
 
@@ -92,57 +197,98 @@ void NGLScene::initializeGL()
   ngl::ShaderLib *shader=ngl::ShaderLib::instance();
   // load a frag and vert shaders
 
-  // we are creating a shader called Phong
-  shader->createShaderProgram("Phong");
-  // now we are going to create empty shaders for Frag and Vert
-  shader->attachShader("PhongVertex",ngl::ShaderType::VERTEX);
-  shader->attachShader("PhongFragment",ngl::ShaderType::FRAGMENT);
-  // attach the source
-  shader->loadShaderSource("PhongVertex","shaders/PhongVertex.glsl");
-  shader->loadShaderSource("PhongFragment","shaders/PhongFragment.glsl");
-  // compile the shaders
-  shader->compileShader("PhongVertex");
-  shader->compileShader("PhongFragment");
-  // add them to the program
-  shader->attachShaderToProgram("Phong","PhongVertex");
-  shader->attachShaderToProgram("Phong","PhongFragment");
-
-  // now we have associated this data we can link the shader
-  shader->linkProgramObject("Phong");
-  // and make it active ready to load values
-  (*shader)["Phong"]->use();
-
-
+  // the placeholder is tiny so it is built straight away, it draws until Phong is ready
+  shader->createShaderProgram("Fallback");
+  shader->attachShader("FallbackVertex",ngl::ShaderType::VERTEX);
+  shader->attachShader("FallbackFragment",ngl::ShaderType::FRAGMENT);
+  shader->loadShaderSource("FallbackVertex","shaders/FallbackVertex.glsl");
+  shader->loadShaderSource("FallbackFragment","shaders/FallbackFragment.glsl");
+  shader->compileShader("FallbackVertex");
+  shader->compileShader("FallbackFragment");
+  shader->attachShaderToProgram("Fallback","FallbackVertex");
+  shader->attachShaderToProgram("Fallback","FallbackFragment");
+  shader->linkProgramObject("Fallback");
+  GLuint fallbackID=shader->getProgramID("Fallback");
+  glUniformBlockBinding(fallbackID,glGetUniformBlockIndex(fallbackID,"TransformData"),TRANSFORM_BLOCK_BINDING);
+
+  // linked programs are cached on disk so later runs skip the driver compiler
+  m_programCache.init(QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString()+"/shaders");
+  // anything not in the cache is compiled in the background, see paintGL
+  m_compileQueue.init();
+  // we are creating shaders called Phong and Colour
+  buildProgram("Phong","shaders/PhongVertex.glsl","shaders/PhongFragment.glsl");
+  buildProgram("Colour","shaders/ColourVertex.glsl","shaders/ColourFragment.glsl");
+
+  // the materials and matrices are in uniform buffers that don't depend on the programs
+  buildMaterials();
+  m_frameBlocks.init(FRAME_BLOCK_BINDING,sizeof(FrameBlock),1);
+  m_transformBlocks.init(TRANSFORM_BLOCK_BINDING,sizeof(TransformBlock),8);
 
+  buildVAO();
+  buildVAO2();
+  buildInstances();
+  buildAnimation();
 
-  shader->createShaderProgram("Colour");
-  // now we are going to create empty shaders for Frag and Vert
-  shader->attachShader("ColourVertex",ngl::ShaderType::VERTEX);
-  shader->attachShader("ColourFragment",ngl::ShaderType::FRAGMENT);
-  // attach the source
-  shader->loadShaderSource("ColourVertex","shaders/ColourVertex.glsl");
-  shader->loadShaderSource("ColourFragment","shaders/ColourFragment.glsl");
-  // compile the shaders
-  shader->compileShader("ColourVertex");
-  shader->compileShader("ColourFragment");
-  // add them to the program
-  shader->attachShaderToProgram("Colour","ColourVertex");
-  shader->attachShaderToProgram("Colour","ColourFragment");
+  m_profiler.initGL();
+  m_text.reset(new ngl::Text(QFont("Arial",12)));
+  m_text->setScreenSize(width(),height());
+  m_text->setColour(1.0f,1.0f,0.0f);
 
-  // now we have associated this data we can link the shader
-  shader->linkProgramObject("Colour");
-  // and make it active ready to load values
-  (*shader)["Phong"]->use();
+  glViewport(0,0,width(),height());
+}
 
-  //  (*shader)["Colour"]->use();
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the cube used for the triangle, the box and the instances, copied from the compile time CUBE_MESH
+//----------------------------------------------------------------------------------------------------------------------
+static MeshData buildCubeMesh()
+{
+  MeshData data;
+  data.m_vertices.assign(CUBE_MESH.m_vertices,CUBE_MESH.m_vertices+CUBE_VERTEX_COUNT);
+  data.m_indices.assign(CUBE_MESH.m_indices,CUBE_MESH.m_indices+CUBE_INDEX_COUNT);
+  return data;
+}
 
+void NGLScene::buildProgram(const std::string &_name, const std::string &_vertexPath, const std::string &_fragmentPath)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram(_name);
+  GLuint programID=shader->getProgramID(_name);
+  std::string key=m_programCache.makeKey({_vertexPath,_fragmentPath});
+  if(m_programCache.load(programID,key))
+  {
+    programReady(_name);
+    return;
+  }
 
+  // ask for a binary we can read back before linking
+  glProgramParameteri(programID,GL_PROGRAM_BINARY_RETRIEVABLE_HINT,GL_TRUE);
+  // the stages are compiled and linked straight into the ShaderLib program, without waiting for the driver
+  m_compileQueue.submit(_name,programID,{{GL_VERTEX_SHADER,_vertexPath},{GL_FRAGMENT_SHADER,_fragmentPath}},
+                        [this,_name,key](GLuint _program, bool _linked)
+                        {
+                          if(_linked)
+                          {
+                            m_programCache.store(_program,key);
+                            programReady(_name);
+                          }
+                        });
+}
 
-  // the shader will use the currently active material and light0 so set them
-  ngl::Material m(ngl::STDMAT::GOLD);
-  // load our material values to the shader into the structure material (see Vertex shader)
-  m.loadToShader("material");
-  shader->setShaderParam3f("viewerPos",m_cam->getEye().m_x,m_cam->getEye().m_y,m_cam->getEye().m_z);
+void NGLScene::programReady(const std::string &_name)
+{
+  if(_name!="Phong")
+  {
+    return;
+  }
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  (*shader)["Phong"]->use();
+  // the matrices, viewer position and materials come from uniform blocks, tie them to their binding points
+  GLuint phongID=shader->getProgramID("Phong");
+  glUniformBlockBinding(phongID,glGetUniformBlockIndex(phongID,"FrameData"),FRAME_BLOCK_BINDING);
+  glUniformBlockBinding(phongID,glGetUniformBlockIndex(phongID,"TransformData"),TRANSFORM_BLOCK_BINDING);
+  glUniformBlockBinding(phongID,glGetUniformBlockIndex(phongID,"MaterialData"),MATERIAL_BLOCK_BINDING);
+  m_instancedLocation=glGetUniformLocation(phongID,"instanced");
+  m_materialIndexLocation=glGetUniformLocation(phongID,"materialIndex");
   // now create our light this is done after the camera so we can pass the
   // transpose of the projection matrix to the light to do correct eye space
   // transformations
@@ -153,11 +299,7 @@ void NGLScene::initializeGL()
   l.setTransform(iv);
   // load these values to the shader as well
   l.loadToShader("light");
-
-  buildVAO();
-  buildVAO2();
-
-  glViewport(0,0,width(),height());
+  m_phongReady=true;
 }
 
 void NGLScene::buildVAO()
@@ -270,236 +412,10 @@ void NGLScene::buildVAO()
 // // now unbind
 //  m_vao->unbind();
 
-    std::array<ngl::Vec3, 36> verts =
-    {
-
-                    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-                    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-                    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-                    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-                    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-                    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-                    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-                    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-                    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-                    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-                    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-                    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-                    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-                    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-                    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-                    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-                    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-                    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-
-                    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-                    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-                    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-                    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-                    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-                    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-
-                    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-                    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-                    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-                    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-                    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-                    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-                    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-                    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-                    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-                    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-                    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-                    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-
-    };
-
-//    ngl::Vec3 verts[]=
-//     {
-////       ngl::Vec3(0,1,1),
-////       ngl::Vec3(0,0,-1),
-////       ngl::Vec3(-0.5,0,1),
-////       ngl::Vec3(0,1,1),
-////       ngl::Vec3(0,0,-1),
-////       ngl::Vec3(0.5,0,1),
-////       ngl::Vec3(0,1,1),
-////       ngl::Vec3(0,0,1.5),
-////       ngl::Vec3(-0.5,0,1),
-////       ngl::Vec3(0,1,1),
-////       ngl::Vec3(0,0,1.5),
-////       ngl::Vec3(0.5,0,1)
-
-//        ////                                      0,1,5,0,4,5, // back
-//        ////                                      3,2,6,7,6,3, // front
-//        ////                                      0,1,2,3,2,0, // top
-//        ////                                      4,5,6,7,6,4, // bottom
-//        ////                                      0,3,4,4,7,3,
-//        ////                                      1,5,2,2,6,5
-
-//        //Create all 12 triangles separately
-//        //6 faces > 12 triangles > 12*3 vertices > 12*3*(3each vertex)= 108 vertices total
-
-//    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-//    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-//    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-//    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-//    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-//    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-//    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-//    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-//    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-//    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-//    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-//    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-//    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-//    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-//    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-//    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-//    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-//    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-
-//    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-//    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-//    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-//    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-//    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-//    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-
-//    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-//    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-//    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-//    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-//    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-//    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-//    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-//    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-//    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-//    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-//    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-//    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-//     };
-
-
-
-
-
-//     ..3 vertices for each triangle..9 coordinates*12= 108 normals total  too
-     std::vector <ngl::Vec3> normals;
-
-     //1st face normals-bottom
-     ngl::Vec3 n=ngl::calcNormal(verts[1],verts[2],verts[0]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-     n=ngl::calcNormal(verts[4],verts[3],verts[5]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //2nd face normals-top
-     n=ngl::calcNormal(verts[7],verts[6],verts[8]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[10],verts[11],verts[9]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //3rd face normals-front
-     n=ngl::calcNormal(verts[13],verts[12],verts[14]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[15],verts[16],verts[17]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //4th face normals-back
-     n=ngl::calcNormal(verts[18],verts[19],verts[20]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[20],verts[21],verts[23]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //5th face normals-left
-     n=ngl::calcNormal(verts[26],verts[25],verts[24]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[27],verts[28],verts[29]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //6th face normals-right
-     n=ngl::calcNormal(verts[31],verts[30],verts[32]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-
-     n=ngl::calcNormal(verts[35],verts[33],verts[34]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-
-
-     std::cout<<"sizeof(verts) "<<sizeof(verts)<<" sizeof(ngl::Vec3) "<<sizeof(ngl::Vec3)<<"\n";
-     // create a vao as a series of GL_TRIANGLES
-//     m_vao= ngl::VertexArrayObject::createVOA(GL_TRIANGLES);
-//     m_vao.reset(ngl::VertexArrayObject::createVOA(GL_TRIANGLES));
-
-     m_vao.reset( ngl::VAOFactory::createVAO(ngl::multiBufferVAO,GL_TRIANGLES));
-     m_vao->bind();
-
-     // in this case we are going to set our data as the vertices above
-
-
-
-     //   m_vao->setData(ngl::SimpleIndexVAO::VertexData( 24*sizeof(GLfloat),vertices[0],sizeof(indices),&indices[0],GL_UNSIGNED_BYTE,GL_STATIC_DRAW));
-     //   // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
-     //   m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
-     //   m_vao->setData(ngl::SimpleIndexVAO::VertexData(24*sizeof(GLfloat),colours[0],sizeof(indices),&indices[0],GL_UNSIGNED_BYTE,GL_STATIC_DRAW));
-     //   // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
-     //   m_vao->setVertexAttributePointer(1,3,GL_FLOAT,0,0);
-     //   m_vao->setNumIndices(sizeof(indices));
-     // // now unbind
-     //  m_vao->unbind();
-
-
-       m_vao->setData(ngl::MultiBufferVAO::VertexData(sizeof(verts)*sizeof(ngl::Vec3),verts[0].m_x,GL_STATIC_DRAW));
-       // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
-
-       m_vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
-       m_vao->setData(ngl::MultiBufferVAO::VertexData(normals.size()*sizeof(ngl::Vec3),normals[0].m_x,GL_STATIC_DRAW));
-
-       // now we set the attribute pointer to be 2 (as this matches normal in our shader)
-
-       m_vao->setVertexAttributePointer(2,3,GL_FLOAT,0,0);
-
-
-       m_vao->setNumIndices(sizeof(verts)/sizeof(ngl::Vec3));
-
-    // now unbind
-     m_vao->unbind();
+    // buildCubeMesh is never empty, which is the only case acquire refuses
+    const MeshRegistry::Mesh *cube=m_meshes.acquire("cube",buildCubeMesh);
+    m_vao=cube->m_vao.get();
+    m_cubeMesh=cube->m_id;
 }
 
 
@@ -561,171 +477,8 @@ void NGLScene::buildVAO()
 
 void NGLScene::buildVAO2()
 {
-
-
-
-    ngl::Vec3 verts[]=
-     {
-
-
-        //Create all 12 triangles separately
-        //6 faces > 12 triangles > 12*3 vertices > 12*3*(3each vertex)= 108 vertices total
-
-    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-
-    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-
-    ngl::Vec3(-1.0f, -1.0f, 1.0f),//fbl 0
-    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-    ngl::Vec3(-1.0f, -1.0f, -1.0f),//bbl 4
-    ngl::Vec3(-1.0f, 1.0f, -1.0f),//bul 7
-    ngl::Vec3(-1.0f, 1.0f, 1.0f),//ful 3
-
-    ngl::Vec3(1.0f, -1.0f, 1.0f),//fbr 1
-    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-    ngl::Vec3(1.0f, 1.0f, 1.0f),//fur 2
-    ngl::Vec3(1.0f, 1.0f, -1.0f),//bur 6
-    ngl::Vec3(1.0f, -1.0f, -1.0f),//bbr 5
-
-
-
-     };
-
-
-//     ..3 vertices for each triangle..9 coordinates*12= 108 normals total  too
-     std::vector <ngl::Vec3> normals;
-
-     //1st face normals-bottom
-     ngl::Vec3 n=ngl::calcNormal(verts[1],verts[2],verts[0]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-     n=ngl::calcNormal(verts[4],verts[3],verts[5]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //2nd face normals-top
-     n=ngl::calcNormal(verts[7],verts[6],verts[8]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[10],verts[11],verts[9]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //3rd face normals-front
-     n=ngl::calcNormal(verts[13],verts[12],verts[14]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[15],verts[16],verts[17]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //4th face normals-back
-     n=ngl::calcNormal(verts[18],verts[19],verts[20]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[20],verts[21],verts[23]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //5th face normals-left
-     n=ngl::calcNormal(verts[26],verts[25],verts[24]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     n=ngl::calcNormal(verts[27],verts[28],verts[29]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-     //6th face normals-right
-     n=ngl::calcNormal(verts[31],verts[30],verts[32]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-
-     n=ngl::calcNormal(verts[35],verts[33],verts[34]);
-     normals.push_back(n);
-     normals.push_back(n);
-     normals.push_back(n);
-
-
-
-     std::cout<<"sizeof(verts) "<<sizeof(verts)<<" sizeof(ngl::Vec3) "<<sizeof(ngl::Vec3)<<"\n";
-     // create a vao as a series of GL_TRIANGLES
-     m_vao2.reset( ngl::VAOFactory::createVAO(ngl::multiBufferVAO,GL_TRIANGLES));
-     m_vao2->bind();
-
-     // in this case we are going to set our data as the vertices above
-
-//       m_vao2->setData(sizeof(verts),verts[0].m_x);
-//       // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
-
-//       m_vao2->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
-
-//       m_vao2->setData(normals.size()*sizeof(ngl::Vec3),normals[0].m_x);
-//       // now we set the attribute pointer to be 2 (as this matches normal in our shader)
-
-//       m_vao2->setVertexAttributePointer(2,3,GL_FLOAT,0,0);
-
-//       m_vao2->setNumIndices(sizeof(verts)/sizeof(ngl::Vec3));
-
-
-     m_vao2->setData(ngl::MultiBufferVAO::VertexData(sizeof(verts)*sizeof(ngl::Vec3),verts[0].m_x,GL_STATIC_DRAW));
-     // now we set the attribute pointer to be 0 (as this matches vertIn in our shader)
-
-     m_vao2->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
-     m_vao2->setData(ngl::MultiBufferVAO::VertexData(normals.size()*sizeof(ngl::Vec3),normals[0].m_x,GL_STATIC_DRAW));
-
-     // now we set the attribute pointer to be 2 (as this matches normal in our shader)
-
-     m_vao2->setVertexAttributePointer(2,3,GL_FLOAT,0,0);
-
-
-     m_vao2->setNumIndices(sizeof(verts)/sizeof(ngl::Vec3));
-
-
-    // now unbind
-     m_vao2->unbind();
-
+  // the box is the same cube, the registry hands back the buffers uploaded by buildVAO
+  m_vao2=m_meshes.acquire("cube",buildCubeMesh)->m_vao.get();
 }
 
 
@@ -778,320 +531,512 @@ void NGLScene::buildVAO2()
 
 
 
-static int t=0;
-static float v1Xcoord;
-const float  startLerp=0.0f;
-const float  endLerp=5.0f;
-static float increment=0.01f;
-static int directionFlag=1;
-
-
-ngl::Mat4 translateMat=1;
-ngl::Mat4 translateMat2=1;
-
-ngl::Mat4 scaleMat=1;
-ngl::Mat4 rotateMat=1;
+void NGLScene::buildInstances()
+{
+  const size_t count=INSTANCE_GRID*INSTANCE_GRID;
+  m_instances.resize(count);
+  // target xyz
+  m_instanceAlignment.resize(count*3);
+  const float offset=(INSTANCE_GRID-1)*INSTANCE_SPACING*0.5f;
+  for(int z=0; z<INSTANCE_GRID; ++z)
+  {
+    for(int x=0; x<INSTANCE_GRID; ++x)
+    {
+      size_t i=z*INSTANCE_GRID+x;
+      InstanceData &instance=m_instances[i];
+      instance.m_translation[0]=x*INSTANCE_SPACING-offset;
+      instance.m_translation[1]=-8.0f;
+      instance.m_translation[2]=z*INSTANCE_SPACING-offset;
+      instance.m_pad=0.0f;
+      // identity until the first update
+      instance.m_rotation[0]=0.0f;
+      instance.m_rotation[1]=0.0f;
+      instance.m_rotation[2]=0.0f;
+      instance.m_rotation[3]=1.0f;
+      // like the demo cube each instance rotates its own position vector onto the target
+      rmath::TransformHandle handle=m_transforms.create(rmath::Vec3(instance.m_translation[0],
+                                                                    instance.m_translation[1],
+                                                                    instance.m_translation[2]));
+      m_transforms.setBoundingRadius(handle,CUBE_BOUNDING_RADIUS);
+      if(i==0)
+      {
+        m_firstInstance=m_transforms.indexOf(handle);
+      }
+    }
+  }
 
-static float testangle;
+  glGenBuffers(1,&m_instanceBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER,m_instanceBuffer);
+  glBufferData(GL_ARRAY_BUFFER,m_instances.size()*sizeof(InstanceData),&m_instances[0],GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+  // room for every instance in each region, the CPU path packs the visible ones in there
+  m_instanceStream.init(GL_ARRAY_BUFFER,m_instances.size()*sizeof(InstanceData));
+  // the instance attributes are recorded in the cube vao
+  m_vao->bind();
+  glEnableVertexAttribArray(4);
+  glVertexAttribDivisor(4,1);
+  glEnableVertexAttribArray(5);
+  glVertexAttribDivisor(5,1);
+  m_vao->unbind();
+  attachInstances(m_instanceBuffer,0);
+
+  // the same pairs for the compute path, the dests are overridden by the target each frame and each instance rotates
+  // its own position so it is also the translation
+  std::vector<ngl::Vec3> starts(count);
+  for(size_t i=0; i<count; ++i)
+  {
+    starts[i].set(m_instances[i].m_translation[0],m_instances[i].m_translation[1],m_instances[i].m_translation[2]);
+  }
+  m_gpuAligner.init("shaders/AlignCompute.glsl",m_instanceBuffer,starts,starts,starts);
+}
 
+void NGLScene::alignInstances(const ngl::Vec3 &_target)
+{
+  const size_t count=m_instances.size();
+  float *target=&m_instanceAlignment[0];
+  // the instances' slice of the transform store, positions in and rotations out
+  rmath::PoseStream poses=m_transforms.poses();
+  const size_t first=m_firstInstance;
+  float *px=poses.m_x+first;
+  float *py=poses.m_y+first;
+  float *pz=poses.m_z+first;
+  const rmath::QuaternionStream q={poses.m_rotation.m_s+first,poses.m_rotation.m_x+first,
+                                   poses.m_rotation.m_y+first,poses.m_rotation.m_z+first};
+  // every instance is aligned so the store stays current for when it comes back into view, whole SIMD blocks per
+  // chunk keep the kernel off its scalar tail
+  m_jobs.parallelFor(count,64,[&](size_t _begin, size_t _end)
+  {
+    std::fill(target+_begin,target+_end,_target.m_x);
+    std::fill(target+count+_begin,target+count+_end,_target.m_y);
+    std::fill(target+2*count+_begin,target+2*count+_end,_target.m_z);
+    rmath::rotationBetweenVectorsBatch({px+_begin,py+_begin,pz+_begin},
+                                       {target+_begin,target+count+_begin,target+2*count+_begin},
+                                       {q.m_s+_begin,q.m_x+_begin,q.m_y+_begin,q.m_z+_begin},_end-_begin);
+  });
+}
 
- void NGLScene::toEuler(double x,double y,double z,double angle, double &heading, double &attitude, double &bank)
- {
-    double s=sin(angle);
-    double c=cos(angle);
-    double t=1-c;
-    //  if axis is not already normalised then uncomment this
-    // double magnitude = Math.sqrt(x*x + y*y + z*z);
-    // if (magnitude==0) throw error;
-    // x /= magnitude;
-    // y /= magnitude;
-    // z /= magnitude;
-    if ((x*y*t + z*s) > 0.998) { // north pole singularity detected
-        heading = 2*atan2(x*sin(angle/2),cos(angle/2));
-        attitude = M_PI/2;
-        bank = 0;
-        return;
-    }
-    if ((x*y*t + z*s) < -0.998) { // south pole singularity detected
-        heading = -2*atan2(x*sin(angle/2),cos(angle/2));
-        attitude = -M_PI/2;
-        bank = 0;
-        return;
+void NGLScene::packInstances()
+{
+  rmath::PoseStream poses=m_transforms.poses();
+  const size_t first=m_firstInstance;
+  const float *px=poses.m_x+first;
+  const float *py=poses.m_y+first;
+  const float *pz=poses.m_z+first;
+  const rmath::QuaternionStream q={poses.m_rotation.m_s+first,poses.m_rotation.m_x+first,
+                                   poses.m_rotation.m_y+first,poses.m_rotation.m_z+first};
+  // only the visible ones are packed, the region holds them front to back with nothing in between
+  const uint32_t *visible=&m_visible[0]+m_firstVisibleInstance;
+  m_instanceDrawCount=m_visibleCount-m_firstVisibleInstance;
+  if(m_instanceDrawCount==0)
+  {
+    return;
+  }
+  // written straight into the mapped region, no staging copy and no glBufferSubData
+  InstanceData *out=static_cast<InstanceData *>(m_instanceStream.beginWrite());
+  if(out==nullptr)
+  {
+    // nothing is drawn this frame rather than instances from stale or unmapped memory
+    m_instanceDrawCount=0;
+    m_repackDirty=true;
+    return;
+  }
+  m_jobs.parallelFor(m_instanceDrawCount,64,[&](size_t _begin, size_t _end)
+  {
+    for(size_t i=_begin; i<_end; ++i)
+    {
+      size_t index=visible[i]-first;
+      InstanceData &instance=out[i];
+      instance.m_rotation[0]=q.m_x[index];
+      instance.m_rotation[1]=q.m_y[index];
+      instance.m_rotation[2]=q.m_z[index];
+      instance.m_rotation[3]=q.m_s[index];
+      instance.m_translation[0]=px[index];
+      instance.m_translation[1]=py[index];
+      instance.m_translation[2]=pz[index];
     }
-    heading = atan2(y * s- x * z * t , 1 - (y*y+ z*z ) * t);
-    attitude = asin(x * y * t + z * s) ;
-    bank = atan2(x * s - y * z * t , 1 - (x*x + z*z) * t);
+  });
+  if(!m_instanceStream.endWrite())
+  {
+    m_instanceDrawCount=0;
+    m_repackDirty=true;
+    return;
+  }
+  attachInstances(m_instanceStream.id(),m_instanceStream.offset());
 }
 
-float vary=1;
-ngl::Vec3 v1;
-ngl::Vec3 v2;
-
-//http://immersivemath.com/forum/question/rotation-matrix-from-one-vector-to-another/
-ngl::Mat4 NGLScene::deriveRotMatrixToRotateV2toV1(ngl::Vec3 start, ngl::Vec3  dest)
+void NGLScene::attachInstances(GLuint _buffer, GLintptr _offset)
 {
-//    The classical answer is that you can create an axis of rotation, a=u×v/||u×v||a=u×v/||u×v||, which is normalized, and compute the angle between uu and vv, i.e., α=arccos(u⋅v)α=arccos⁡(u⋅v). The rotation matrix is then:
-//    M=⎛⎝⎜a2x(1−c)+caxay(1−c)+sazaxaz(1−c)–sayaxay(1−c)–saza2y(1−c)+cayaz(1−c)+saxaxaz(1−c)+sayayaz(1−c)−saxa2z(1−c)+c⎞⎠⎟
-//    M=(ax2(1−c)+caxay(1−c)–sazaxaz(1−c)+sayaxay(1−c)+sazay2(1−c)+cayaz(1−c)−saxaxaz(1−c)–sayayaz(1−c)+saxaz2(1−c)+c)
-
-//    where c=cosαc=cos⁡α and s=sinαs=sin⁡α. It should be possible to show that v=Muv=Mu.
-
-
-    ngl::Vec3 axis=start.cross(dest);
-    axis.normalize();
-    float a=acos(start.dot(dest));
-    float c=cos(a);
-    float s=sin(a);
-
-    ngl::Mat4 rotMat( (axis.m_x*axis.m_x)*(1-c)+c,           (axis.m_x*axis.m_y)*(1-c)-s*axis.m_z,  (axis.m_x*axis.m_z)*(1-c)+s*axis.m_y, 0,
-                      (axis.m_x*axis.m_y)*(1-c)+s*axis.m_z,  (axis.m_y*axis.m_y)*(1-c)+c,           (axis.m_y*axis.m_z)*(1-c)-s*axis.m_x, 0,
-                      (axis.m_x*axis.m_z)*(1-c)-s*axis.m_y,  (axis.m_y*axis.m_z)*(1-c)+s*axis.m_x,  (axis.m_z*axis.m_z)*(1-c)+c, 0,
-                      0,                                         0  ,                                     0   ,                        1
-                      );
-
-    return rotMat;
-
+  m_vao->bind();
+  glBindBuffer(GL_ARRAY_BUFFER,_buffer);
+  glVertexAttribPointer(4,4,GL_FLOAT,GL_FALSE,sizeof(InstanceData),
+                        reinterpret_cast<GLvoid *>(_offset+offsetof(InstanceData,m_rotation)));
+  glVertexAttribPointer(5,3,GL_FLOAT,GL_FALSE,sizeof(InstanceData),
+                        reinterpret_cast<GLvoid *>(_offset+offsetof(InstanceData,m_translation)));
+  m_vao->unbind();
+  glBindBuffer(GL_ARRAY_BUFFER,0);
 }
 
-//return shortest arc quaternion that rotates start to dest
- ngl::Quaternion NGLScene::RotationBetweenVectors(ngl::Vec3 start, ngl::Vec3  dest){
-
-     ngl::Quaternion q;
-
-     (start).normalize();
-
-     (dest).normalize();
-
-
-
-     float cosTheta = start.dot(dest);
-
-     ngl::Vec3  rotationAxis;
-
-
-     /**
-      * https://bitbucket.org/sinbad/ogre/src/9db75e3ba05c/OgreMain/include/OgreVector3.h?fileviewer=file-view-default#cl-651
-      *
-      * Gets the shortest arc quaternion to rotate this vector to the destination
-                vector.
-            @remarks
-                If you call this with a dest vector that is close to the inverse
-                of this vector, we will rotate 180 degrees around the 'fallbackAxis'
-                (if specified, or a generated axis if not) since in this case
-                ANY axis of rotation is valid.
- */
-     if (cosTheta >= 1.0f)//same vectors
-     {
-         return ngl::Quaternion();//identity quaternion
-     }
-
-     if (cosTheta < (1e-6f - 1.0f))
-     {
-         // Generate an axis
-         rotationAxis = ngl::Vec3 (0.0f, 0.0f, 1.0f).cross( start);
-
-         if (rotationAxis.length()==0) // pick another if colinear
-             rotationAxis = ngl::Vec3 (0.0f, 1.0f, 0.0f).cross( start);
-
-         rotationAxis.normalize();
-         q.fromAxisAngle(rotationAxis,180.0f);
-        return q;
-     }
-
-
-
-
- //    if (cosTheta < -1 + 0.001f)
- //    {
-
- //        // special case when vectors in opposite directions:
-
- //        // there is no "ideal" rotation axis
-
- //        // So guess one; any will do as long as it's perpendicular to start
-
- //        rotationAxis = ngl::Vec3 (0.0f, 0.0f, 1.0f).cross( start);
-
- //        float t=rotationAxis.lengthSquared();
- //        if (t< 0.01 ) // bad luck, they were parallel, try again!
-
- //            rotationAxis = ngl::Vec3 (1.0f, 0.0f, 0.0f).cross( start);
-
-
- //        (rotationAxis).normalize();
-
- //        q.fromAxisAngle(rotationAxis,180.0f);
-
- //        return q;
- //    }
-
-
-
-     rotationAxis = start.cross(dest);
-
-
-
-     float s = sqrt( (1+cosTheta)*2 );
-
-     float invs = 1 / s;
-
-
-
-     return ngl::Quaternion(
+float NGLScene::viewDepth(SceneObject _object) const
+{
+  // the translation row of the world matrix is the origin, the camera looks down its -z
+  rmath::Mat4 world=m_transforms.worldMatrix(m_transforms.indexOf(m_objectTransform[_object]));
+  const float *origin=world.m_m[3];
+  return -(origin[0]*m_view.m_m[0][2]+origin[1]*m_view.m_m[1][2]+origin[2]*m_view.m_m[2][2]+m_view.m_m[3][2]);
+}
 
-         s * 0.5f,
+void NGLScene::cullObjects()
+{
+  // the store's positions are before the root transform so the frustum is taken from root * view * projection, the
+  // root (mouse spin and pan) has no scale so the radii carry over
+  rmath::Frustum frustum=rmath::frustumFromMatrix(toRMath(m_mouseGlobalTX*m_viewProject));
+  m_visible.resize(m_transforms.size());
+  m_visibleCount=rmath::cullSpheres(frustum,m_transforms.positions(),m_transforms.boundingRadii(),0,m_transforms.size(),
+                                    &m_visible[0]);
+  std::vector<uint32_t>::const_iterator begin=m_visible.begin();
+  std::vector<uint32_t>::const_iterator end=begin+m_visibleCount;
+  for(int i=0; i<OBJECT_COUNT; ++i)
+  {
+    m_objectVisible[i]=std::binary_search(begin,end,static_cast<uint32_t>(m_transforms.indexOf(m_objectTransform[i])));
+  }
+  m_firstVisibleInstance=std::lower_bound(begin,end,static_cast<uint32_t>(m_firstInstance))-begin;
+  // a different set of instances has to be packed, their alignment is unchanged
+  m_repackDirty=true;
+}
 
-         rotationAxis.m_x * invs,
 
-         rotationAxis.m_y * invs,
 
-         rotationAxis.m_z * invs
+void NGLScene::buildMaterials()
+{
+  std::array<MaterialBlock,MAX_MATERIALS> table={};
+  table[PEWTER_MATERIAL].set(ngl::Material(ngl::STDMAT::PEWTER));
+  table[BRONZE_MATERIAL].set(ngl::Material(ngl::STDMAT::BRONZE));
+  table[GOLD_MATERIAL].set(ngl::Material(ngl::STDMAT::GOLD));
+  // the whole table is one block, it never changes so it is bound here and left bound
+  m_materialBlocks.init(MATERIAL_BLOCK_BINDING,sizeof(table),1);
+  m_materialBlocks.push(&table[0]);
+  m_materialBlocks.upload();
+  m_materialBlocks.bind(0);
+}
 
-     );
+void NGLScene::useMaterial(GLint _index)
+{
+  glUniform1i(m_materialIndexLocation,_index);
+}
 
+void NGLScene::setTransform(SceneObject _object, const ngl::Mat4 &_M)
+{
+  ngl::Mat4 MV=_M*m_view;
+  ngl::Mat4 MVP=_M*m_viewProject;
+  ngl::Mat3 normalMatrix;
+  normalMatrix=MV;
+  normalMatrix.inverse();
+  TransformBlock block;
+  block.set(_M,MV,MVP,normalMatrix);
+  m_transformBlocks.set(_object,&block);
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the demo swings 0 -> 89 -> -89 -> 0 one degree a step
+//----------------------------------------------------------------------------------------------------------------------
+const static int ANIMATION_PERIOD=4*89;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the swing angle in degrees after _step steps
+//----------------------------------------------------------------------------------------------------------------------
+static int swingAngle(int _step)
+{
+  int phase=_step%ANIMATION_PERIOD;
+  if(phase<=89)
+  {
+    return phase;
   }
-
-
-
-void NGLScene::paintGL()
+  if(phase<=3*89)
+  {
+    return 2*89-phase;
+  }
+  return phase-ANIMATION_PERIOD;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the tracks of m_animation
+//----------------------------------------------------------------------------------------------------------------------
+enum AnimationTrack
 {
+  CUBE_TRACK=0,
+  TRIANGLE_TRACK,
+  TRACK_COUNT
+};
 
-    if(testangle==89)
-        vary=-1;
-
-    if(testangle==-89)
-        vary=1;
+void NGLScene::stepSimulation()
+{
+  ++m_animationStep;
+  m_animationDirty=true;
+}
 
-//This bit has been  MOVED TO TIMER EVENT for more 'slow-motion' control
-//    testangle+=vary;
-    std::cout<<testangle<<std::endl;
+void NGLScene::buildAnimation()
+{
+  // bake the demo motion (v1 for the cube, v2 for the triangle) with a key every step so it is unchanged, the
+  // trig is then done once here instead of every frame
+  std::vector<rmath::PositionKey> cubeKeys;
+  std::vector<rmath::PositionKey> triangleKeys;
+  for(int step=0; step<=ANIMATION_PERIOD; ++step)
+  {
+    float a=swingAngle(step);
+    float time=step;
+    cubeKeys.push_back({time,rmath::Vec3(-5+15*sin((a)*(M_PI/180))-2,-5+15*sin((a)*(M_PI/180)),  4*sin((a)*(M_PI/180))-2)});
+    triangleKeys.push_back({time,rmath::Vec3(-4,0.01,-5+15*sin((a)*(M_PI/180)))});
+  }
+  // the triangle's orientation is worked out from v1 and v2 each frame, so no rotation keys
+  std::vector<rmath::RotationKey> fixed(1,rmath::RotationKey{0.0f,rmath::Quaternion()});
+  m_animation.clear();
+  m_animation.addTrack(cubeKeys,fixed);
+  m_animation.addTrack(triangleKeys,fixed);
+}
 
-    ngl::Vec3 v1(-5+15*sin((testangle)*(M_PI/180))-2,-5+15*sin((testangle)*(M_PI/180)),  4*sin((testangle)*(M_PI/180))-2);
-    ngl::Vec3 v2(-4,0.01,-5+15*sin((testangle)*(M_PI/180)));//transform the triangle vao to 2,2,0
+void NGLScene::updateAnimation()
+{
+    Tracer &tracer=Tracer::instance();
+    float x[TRACK_COUNT];
+    float y[TRACK_COUNT];
+    float z[TRACK_COUNT];
+    float rs[TRACK_COUNT];
+    float rx[TRACK_COUNT];
+    float ry[TRACK_COUNT];
+    float rz[TRACK_COUNT];
+    m_animation.sample(static_cast<float>(m_animationStep%ANIMATION_PERIOD),{x,y,z,{rs,rx,ry,rz}},
+                       rmath::RotationInterpolation::NLERP,&m_jobs);
+    ngl::Vec3 v1(x[CUBE_TRACK],y[CUBE_TRACK],z[CUBE_TRACK]);
+    ngl::Vec3 v2(x[TRIANGLE_TRACK],y[TRIANGLE_TRACK],z[TRIANGLE_TRACK]);//transform the triangle vao to 2,2,0
 
       ngl::Vec3 v2NonNormalized=v2;
       ngl::Vec3 v1NonNormalized=v1;
-
-
-  // clear the screen and depth buffer
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  // Rotation based on the mouse position for our global transform
-
-  // Rotation based on the mouse position for our global
-  // transform
-  ngl::Mat4 rotX;
-  ngl::Mat4 rotY;
-  // create the rotation matrices
-  rotX.rotateX(m_spinXFace);
-  rotY.rotateY(m_spinYFace);
-  // multiply the rotations
-  m_mouseGlobalTX=rotY*rotX;
-  // add the translations
-  m_mouseGlobalTX.m_m[3][0] = m_modelPos.m_x;
-  m_mouseGlobalTX.m_m[3][1] = m_modelPos.m_y;
-  m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
-
-
-  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-  (*shader)["Phong"]->use();
-//  (*shader)["Colour"]->use();
-
-  ngl::Material m(ngl::STDMAT::PEWTER);
-  // load our material values to the shader into the structure material (see Vertex shader)
-  m.loadToShader("material");
-
-  ngl::Mat4 MV;
-  ngl::Mat4 MVP;
-  ngl::Mat3 normalMatrix;
-  ngl::Mat4 M;
-
+      m_alignTarget=v1NonNormalized;
 
   //*********
-  m_transform.reset();
-  //draw box
-  {
-      m_transform.setPosition(v1NonNormalized);
-      M=m_transform.getMatrix()*m_mouseGlobalTX;
-      MV=  M*m_cam->getViewMatrix();
-      MVP= M*m_cam->getVPMatrix();
-      normalMatrix=MV;
-      normalMatrix.inverse();
-      shader->setShaderParamFromMat4("MV",MV);
-      shader->setShaderParamFromMat4("MVP",MVP);
-      shader->setShaderParamFromMat3("normalMatrix",normalMatrix);
-      shader->setShaderParamFromMat4("M",M);
-
-
-      //ngl::VAOPrimitives::instance()->draw("cube");
-      m_vao2->bind();
-      m_vao2->draw();
-      m_vao2->unbind();
-
-  }
+  //box
+  m_transforms.setPosition(m_objectTransform[BOX_OBJECT],toRMath(v1NonNormalized));
 
 
     v1.normalize();
     v2.normalize();
-    float angle = /*atan2(v1.m_y,v1.m_x) - atan2(v2.m_y,v2.m_x);//*/acos(v1.dot(v2));
-
-    ngl::Vec3 rotationAxis = v1.cross(v2);
-    rotationAxis.normalize();
 
-//    ngl::Quaternion q ;
-//    q.fromAxisAngle(rotationAxis,angle);
-
-    ngl::Mat4 s,rotateMat,translateMat;
-    s=1;
-
-    //Use either RotationBetweenVectors or
+    //Use either rmath::rotationBetweenVectors or
     //(deriveRotMatrixToRotateV2toV1 or matrixFromAxisAngle) both the same in different form
-    rotateMat=RotationBetweenVectors(v2,v1).toMat4();
-//    rotateMat=deriveRotMatrixToRotateV2toV1(v2,v1);
-
-//    rotateMat=matrixFromAxisAngle(rotationAxis,angle);//q.toMat4();
-
-
-    //calculate euler angles from axis-angle
-//    double heading,attitude,bank;
-//    toEuler(rotationAxis.m_x, rotationAxis.m_y, rotationAxis.m_z, angle, heading, attitude, bank);
+    rmath::Quaternion rotation=rmath::rotationBetweenVectors(toRMath(v2),toRMath(v1));
+    tracer.record(TraceEventType::ROTATIONFROM,m_frameNumber,v2.m_x,v2.m_y,v2.m_z);
+    tracer.record(TraceEventType::ROTATIONTO,m_frameNumber,v1.m_x,v1.m_y,v1.m_z);
+    tracer.record(TraceEventType::ROTATIONRESULT,m_frameNumber,rotation.m_s,rotation.m_x,rotation.m_y,rotation.m_z);
+//    rotateMat=toNGL(rmath::deriveRotMatrixToRotateV2toV1(toRMath(v2),toRMath(v1)));
+
+//    rotateMat=toNGL(rmath::matrixFromAxisAngle(toRMath(rotationAxis),angle));//q.toMat4();
+
+  //triangle, rotated about its own origin then moved to v2
+  m_transforms.setRotation(m_objectTransform[TRIANGLE_OBJECT],rotation);
+  m_transforms.setPosition(m_objectTransform[TRIANGLE_OBJECT],toRMath(v2NonNormalized));
+  // the per instance transform is built in the shader so INSTANCES_OBJECT keeps the identity and M is only the root
+}
 
-//    m_transform.reset();
-//    std::cout<<bank*(180/M_PI)<<","<<heading*(180/M_PI)<<","<<attitude*(180/M_PI)<<","<<std::endl;
-//    m_transform.setRotation(bank*(180/M_PI),heading*(180/M_PI),attitude*(180/M_PI));
-//    r= m_transform.getMatrix();
+void NGLScene::scheduleNextFrame()
+{
+  if(m_inputReplayer.isActive())
+  {
+    // replays run flat out and quit at the end
+    if(isReplayFinished())
+    {
+      reportReplay();
+      QGuiApplication::quit();
+    }
+    else
+    {
+      update();
+    }
+  }
+  else if(m_compileQueue.isPending())
+  {
+    // keep drawing (and polling) until every program is in
+    update();
+  }
+  else if(!m_scheduler.isPaused())
+  {
+    m_stepTimer.start(m_scheduler.msUntilNextStep());
+  }
+}
 
-    m_transform.reset();
-    m_transform.setPosition(v2NonNormalized);
-    translateMat= m_transform.getMatrix();
+void NGLScene::paintGL()
+{
+    m_profiler.beginFrame();
+    // run the fixed steps that have come due since the last frame, one step every 100 millisecs, or when replaying
+    // the input and steps recorded for this frame
+    int steps=0;
+    if(m_inputReplayer.isActive())
+    {
+      if(!m_replayClock.isValid())
+      {
+        // every frame of the replay is drawn with the real shaders, however long they take to build on this machine
+        finishLoading();
+        m_replayClock.start();
+      }
+      while(const InputEvent *event=m_inputReplayer.next(m_frameNumber))
+      {
+        if(event->m_type==InputEventType::STEPS)
+        {
+          steps+=event->m_x;
+        }
+        else
+        {
+          applyInput(*event);
+        }
+      }
+    }
+    else
+    {
+      steps=m_scheduler.advance();
+      if(steps>0)
+      {
+        m_inputRecorder.record(InputEventType::STEPS,m_frameNumber,0,steps);
+      }
+    }
+    for(; steps>0; --steps)
+    {
+      stepSimulation();
+    }
+    Tracer &tracer=Tracer::instance();
+    tracer.record(TraceEventType::FRAMEBEGIN,m_frameNumber);
+    tracer.record(TraceEventType::ANGLE,m_frameNumber,static_cast<float>(swingAngle(m_animationStep)));
 
+  // clear the screen and depth buffer
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    ngl::Mat4 modelmatrix=s*rotateMat*translateMat;
+  {
+  // CPU side matrix work, only what has changed since the last frame is rebuilt and staged for the upload below
+  FrameProfiler::ScopedTimer matricesTimer(m_profiler,FrameProfiler::MATRICES);
+  if(m_cameraDirty)
+  {
+    m_view=m_cam->getViewMatrix();
+    m_viewProject=m_cam->getVPMatrix();
+    // camera data is shared by every draw
+    FrameBlock frame;
+    frame.set(m_view,m_viewProject,m_cam->getEye().toVec3());
+    m_frameBlocks.clear();
+    m_frameBlocks.push(&frame);
+    std::fill(std::begin(m_objectDirty),std::end(m_objectDirty),true);
+    m_cullDirty=true;
+    m_cameraDirty=false;
+  }
+  if(m_mouseTXDirty)
+  {
+    // Rotation based on the mouse position for our global
+    // transform
+    ngl::Mat4 rotX;
+    ngl::Mat4 rotY;
+    // create the rotation matrices
+    rotX.rotateX(m_spinXFace);
+    rotY.rotateY(m_spinYFace);
+    // multiply the rotations
+    m_mouseGlobalTX=rotY*rotX;
+    // add the translations
+    m_mouseGlobalTX.m_m[3][0] = m_modelPos.m_x;
+    m_mouseGlobalTX.m_m[3][1] = m_modelPos.m_y;
+    m_mouseGlobalTX.m_m[3][2] = m_modelPos.m_z;
+    m_transforms.setRoot(toRMath(m_mouseGlobalTX));
+    std::fill(std::begin(m_objectDirty),std::end(m_objectDirty),true);
+    m_cullDirty=true;
+    m_mouseTXDirty=false;
+  }
+  if(m_animationDirty)
+  {
+    updateAnimation();
+    m_objectDirty[BOX_OBJECT]=true;
+    m_objectDirty[TRIANGLE_OBJECT]=true;
+    m_alignmentDirty=true;
+    m_cullDirty=true;
+    m_animationDirty=false;
+  }
+  for(int i=0; i<OBJECT_COUNT; ++i)
+  {
+    if(m_objectDirty[i])
+    {
+      SceneObject object=static_cast<SceneObject>(i);
+      setTransform(object,toNGL(m_transforms.worldMatrix(m_transforms.indexOf(m_objectTransform[object]))));
+      m_objectDirty[i]=false;
+    }
+  }
+  }
 
-  m_transform.reset();
-  //draw triangle
+  if(m_cullDirty)
   {
-      //    load our material values to the shader into the structure material (see Vertex shader)
-      m.set(ngl::STDMAT::BRONZE);
-      m.loadToShader("material");
+    FrameProfiler::ScopedTimer cullTimer(m_profiler,FrameProfiler::CULL);
+    cullObjects();
+    m_cullDirty=false;
+  }
 
-      M=/*m_transform.getMatrix()*/  modelmatrix*m_mouseGlobalTX;
-      MV=  M*m_cam->getViewMatrix();
-      MVP= M*m_cam->getVPMatrix();
-      normalMatrix=MV;
-      normalMatrix.inverse();
-      shader->setShaderParamFromMat4("MV",MV);
-      shader->setShaderParamFromMat4("MVP",MVP);
-      shader->setShaderParamFromMat3("normalMatrix",normalMatrix);
-      shader->setShaderParamFromMat4("M",M);
+  {
+  FrameProfiler::ScopedTimer uploadsTimer(m_profiler,FrameProfiler::UPLOADS);
+  // both are no-ops unless a block changed above
+  m_frameBlocks.upload();
+  m_frameBlocks.bind(0);
+  m_transformBlocks.upload();
+  }
 
+  // the instanced cubes, each aligned to v1 like the triangle, need Phong to build the instance transforms
+  bool drawInstances=m_drawInstanced && m_phongReady;
+  if(drawInstances && (m_alignmentDirty || m_repackDirty))
+  {
+    FrameProfiler::ScopedTimer instancesTimer(m_profiler,FrameProfiler::INSTANCES);
+    if(m_alignOnGPU && m_gpuAligner.isAvailable())
+    {
+      // the compute shader aligns and packs the visible instances in one pass so either change redoes both
+      m_gpuAligner.select(&m_visible[0]+m_firstVisibleInstance,m_visibleCount-m_firstVisibleInstance,
+                          static_cast<uint32_t>(m_firstInstance));
+      m_gpuAligner.dispatch(m_alignTarget);
+      m_instanceDrawCount=m_gpuAligner.selectedCount();
+      attachInstances(m_instanceBuffer,0);
+      m_alignmentDirty=false;
+      m_repackDirty=false;
+    }
+    else
+    {
+      // moving the view only changes which instances are visible, the store already holds their rotations
+      if(m_alignmentDirty)
+      {
+        alignInstances(m_alignTarget);
+        m_alignmentDirty=false;
+      }
+      // packInstances sets it again if the stream could not be written so the next frame retries
+      m_repackDirty=false;
+      packInstances();
+    }
+  }
 
-//      ngl::VAOPrimitives::instance()->draw("cube");
-      m_vao->bind();
-      m_vao->draw();
-      m_vao->unbind();
+  {
+  FrameProfiler::ScopedTimer sortTimer(m_profiler,FrameProfiler::SORT);
+  // until Phong has been compiled everything is drawn flat with the placeholder
+  uint32_t program= m_phongReady ? PHONG_PROGRAM : FALLBACK_PROGRAM;
+  m_drawQueue.clear();
+  if(m_objectVisible[BOX_OBJECT])
+  {
+    m_drawQueue.push(program,PEWTER_MATERIAL,m_cubeMesh,viewDepth(BOX_OBJECT),BOX_OBJECT);
+  }
+  if(m_objectVisible[TRIANGLE_OBJECT])
+  {
+    m_drawQueue.push(program,BRONZE_MATERIAL,m_cubeMesh,viewDepth(TRIANGLE_OBJECT),TRIANGLE_OBJECT);
+  }
+  if(drawInstances && m_instanceDrawCount!=0)
+  {
+    m_drawQueue.push(PHONG_INSTANCED_PROGRAM,GOLD_MATERIAL,m_cubeMesh,viewDepth(INSTANCES_OBJECT),INSTANCES_OBJECT,
+                     static_cast<uint32_t>(m_instanceDrawCount));
+  }
+  m_drawQueue.sort();
+  }
 
-   }
+  {
+  FrameProfiler::ScopedTimer drawTimer(m_profiler,FrameProfiler::DRAW);
+  m_drawQueue.submit(m_drawBackend);
+  glBindVertexArray(0);
+  // the instance region just drawn from can't be rewritten until the GPU is past these draws
+  if(drawInstances)
+  {
+    m_instanceStream.fence();
+  }
+  }
 
 
 
@@ -1366,216 +1311,238 @@ void NGLScene::paintGL()
 
 
 
-}
-
-
+  m_profiler.endFrame();
+  // drawn outside the timed frame so the overlay does not measure itself
+  drawHUD();
+  // pick up any programs that finished compiling, after the frame so the first one is never held up
+  m_compileQueue.poll();
 
-ngl::Mat4 NGLScene::matrixFromAxisAngle(ngl::Vec3 axis, float angle) {
-
-    ngl::Mat4 tmp=1;
-
-    double c = cos(angle);
-    double s = sin(angle);
-    double t = 1.0 - c;
-    //  if axis is not already normalised then uncomment this
-    // double magnitude = sqrt(axis.x*axis.x + axis.m_y*axis.m_y + axis.m_z*axis.m_z);
-    // if (magnitude==0) throw error;
-    // axis.x /= magnitude;
-    // axis.m_y /= magnitude;
-    // axis.m_z /= magnitude;
-
-    tmp.m_00 = c + axis.m_x*axis.m_x*t;
-    tmp.m_11 = c + axis.m_y*axis.m_y*t;
-    tmp.m_22 = c + axis.m_z*axis.m_z*t;
-
-
-    double tmp1 = axis.m_x*axis.m_y*t;
-    double tmp2 = axis.m_z*s;
-    tmp.m_10 = tmp1 + tmp2;
-    tmp.m_01 = tmp1 - tmp2;
-    tmp1 = axis.m_x*axis.m_z*t;
-    tmp2 = axis.m_y*s;
-    tmp.m_20 = tmp1 - tmp2;
-    tmp.m_02 = tmp1 + tmp2;
-    tmp1 = axis.m_y*axis.m_z*t;
-    tmp2 = axis.m_x*s;
-    tmp.m_21 = tmp1 + tmp2;
-    tmp.m_12 = tmp1 - tmp2;
-
-    return tmp;
-}
-
-
-//Heading = rotation about y axis
-//Attitude = rotation about z axis
-//Bank = rotation about x axis
-void NGLScene::toEuler(double x,double y,double z,double angle) {
-    float heading;
-    float attitude;
-    float bank;
-    double s=sin(angle);
-    double c=cos(angle);
-    double t=1-c;
-    //  if axis is not already normalised then uncomment this
-    // double magnitude = sqrt(x*x + y*y + z*z);
-    // if (magnitude==0) throw error;
-    // x /= magnitude;
-    // y /= magnitude;
-    // z /= magnitude;
-    if ((x*y*t + z*s) > 0.998) { // north pole singularity detected
-        heading = 2*atan2(x*sin(angle/2),cos(angle/2));
-        attitude = M_PI/2;
-        bank = 0;
-        return;
-    }
-    if ((x*y*t + z*s) < -0.998) { // south pole singularity detected
-        heading = -2*atan2(x*sin(angle/2),cos(angle/2));
-        attitude = -M_PI/2;
-        bank = 0;
-        return;
-    }
-
-    heading = atan2(y * s- x * z * t , 1 - (y*y+ z*z ) * t);
-    attitude = asin(x * y * t + z * s) ;
-    bank = atan2(x * s - y * z * t , 1 - (x*x + z*z) * t);
-
-    eulerAngles.set(bank,heading,attitude);
+  tracer.record(TraceEventType::FRAMEEND,m_frameNumber);
+  ++m_frameNumber;
 }
 
-
-
-//----------------------------------------------------------------------------------------------------------------------
-void NGLScene::mouseMoveEvent (QMouseEvent * _event)
+void NGLScene::finishLoading()
 {
-  // note the method buttons() is the button state when event was called
-  // this is different from button() which is used to check which button was
-  // pressed when the mousePress/Release event is generated
-  if(m_rotate && _event->buttons() == Qt::LeftButton)
+  while(m_compileQueue.poll())
   {
-    int diffx=_event->x()-m_origX;
-    int diffy=_event->y()-m_origY;
-    m_spinXFace += (float) 0.5f * diffy;
-    m_spinYFace += (float) 0.5f * diffx;
-    m_origX = _event->x();
-    m_origY = _event->y();
-    update();
-
   }
-        // right mouse translate code
-  else if(m_translate && _event->buttons() == Qt::RightButton)
-  {
-    int diffX = (int)(_event->x() - m_origXPos);
-    int diffY = (int)(_event->y() - m_origYPos);
-    m_origXPos=_event->x();
-    m_origYPos=_event->y();
-    m_modelPos.m_x += INCREMENT * diffX;
-    m_modelPos.m_y -= INCREMENT * diffY;
-    update();
-
-   }
 }
 
-
-//----------------------------------------------------------------------------------------------------------------------
-void NGLScene::mousePressEvent ( QMouseEvent * _event)
+void NGLScene::drawHUD()
 {
-  // this method is called when the mouse button is pressed in this case we
-  // store the value where the maouse was clicked (x,y) and set the Rotate flag to true
-  if(_event->button() == Qt::LeftButton)
+  if(!m_showHUD)
   {
-    m_origX = _event->x();
-    m_origY = _event->y();
-    m_rotate =true;
+    return;
   }
-  // right mouse translate mode
-  else if(_event->button() == Qt::RightButton)
+  const float lineHeight=18.0f;
+  float y=10.0f;
+  const FrameProfiler::Stats &cpu=m_profiler.cpuFrameStats();
+  const FrameProfiler::Stats &gpu=m_profiler.gpuFrameStats();
+  m_text->renderText(10,y,QString("cpu frame avg %1 ms p99 %2 ms").arg(cpu.m_mean,0,'f',3).arg(cpu.m_p99,0,'f',3));
+  y+=lineHeight;
+  if(gpu.m_samples!=0)
   {
-    m_origXPos = _event->x();
-    m_origYPos = _event->y();
-    m_translate=true;
+    m_text->renderText(10,y,QString("gpu frame avg %1 ms p99 %2 ms").arg(gpu.m_mean,0,'f',3).arg(gpu.m_p99,0,'f',3));
   }
+  else
+  {
+    m_text->renderText(10,y,"gpu frame n/a");
+  }
+  y+=lineHeight;
+  for(int i=0; i<FrameProfiler::SECTIONCOUNT; ++i)
+  {
+    FrameProfiler::Section section=static_cast<FrameProfiler::Section>(i);
+    const FrameProfiler::Stats &stats=m_profiler.sectionStats(section);
+    m_text->renderText(10,y,QString("  %1 avg %2 ms p99 %3 ms").arg(FrameProfiler::sectionName(section))
+                                                                .arg(stats.m_mean,0,'f',3).arg(stats.m_p99,0,'f',3));
+    y+=lineHeight;
+  }
+  m_text->renderText(10,y,QString("visible %1 of %2 objects").arg(m_visibleCount).arg(m_transforms.size()));
+  y+=lineHeight;
+  const DrawQueue::Stats &draws=m_drawQueue.stats();
+  m_text->renderText(10,y,QString("draws %1 state changes %2 skipped %3").arg(draws.m_draws)
+                                                                         .arg(draws.m_stateChanges).arg(draws.m_skipped));
+}
+
+
 
+bool NGLScene::recordInput(const std::string &_path)
+{
+  return m_inputRecorder.start(_path);
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-void NGLScene::mouseReleaseEvent ( QMouseEvent * _event )
+bool NGLScene::replayInput(const std::string &_path)
+{
+  return m_inputReplayer.load(_path);
+}
+
+bool NGLScene::isReplayFinished() const
 {
-  // this event is called when the mouse button is released
-  // we then set Rotate to false
-  if (_event->button() == Qt::LeftButton)
+  return m_inputReplayer.isActive() && m_frameNumber>=m_inputReplayer.frameCount();
+}
+
+void NGLScene::reportReplay()
+{
+  double elapsedMs=m_replayClock.nsecsElapsed()/1000000.0;
+  std::cout<<"replay : "<<m_frameNumber<<" frames in "<<elapsedMs<<" ms ("<<m_frameNumber*1000.0/elapsedMs<<" fps)\n";
+  const FrameProfiler::Stats &cpu=m_profiler.cpuFrameStats();
+  const FrameProfiler::Stats &gpu=m_profiler.gpuFrameStats();
+  std::cout<<"cpu frame avg "<<cpu.m_mean<<" ms p99 "<<cpu.m_p99<<" ms\n";
+  if(gpu.m_samples!=0)
   {
-    m_rotate=false;
+    std::cout<<"gpu frame avg "<<gpu.m_mean<<" ms p99 "<<gpu.m_p99<<" ms\n";
   }
-        // right mouse translate mode
-  if (_event->button() == Qt::RightButton)
+  const DrawQueue::Stats &draws=m_drawQueue.stats();
+  std::cout<<"last frame "<<draws.m_draws<<" draws "<<draws.m_stateChanges<<" state changes "<<draws.m_skipped
+           <<" skipped\n";
+  std::cout<<"instance stream "<<(m_instanceStream.isPersistent() ? "persistent" : "fallback")<<" "
+           <<m_instanceStream.stalls()<<" stalls\n";
+}
+
+void NGLScene::handleInput(InputEventType _type, int _button, int _x, int _y)
+{
+  if(m_inputReplayer.isActive())
   {
-    m_translate=false;
+    return;
   }
+  InputEvent event;
+  event.m_frame=m_frameNumber;
+  event.m_type=_type;
+  event.m_button=static_cast<uint8_t>(_button);
+  event.m_pad=0;
+  event.m_x=_x;
+  event.m_y=_y;
+  m_inputRecorder.record(_type,m_frameNumber,_button,_x,_y);
+  applyInput(event);
 }
 
-//----------------------------------------------------------------------------------------------------------------------
-void NGLScene::wheelEvent(QWheelEvent *_event)
+void NGLScene::applyInput(const InputEvent &_event)
 {
-
+  switch(_event.m_type)
+  {
+  case InputEventType::MOUSEMOVE :
+    // note m_button is the button state when event was called
+    // this is different from the button of a press / release which is the button that changed
+    if(m_rotate && _event.m_button == Qt::LeftButton)
+    {
+      int diffx=_event.m_x-m_origX;
+      int diffy=_event.m_y-m_origY;
+      m_spinXFace += (float) 0.5f * diffy;
+      m_spinYFace += (float) 0.5f * diffx;
+      m_origX = _event.m_x;
+      m_origY = _event.m_y;
+      m_mouseTXDirty=true;
+      update();
+    }
+    // right mouse translate code
+    else if(m_translate && _event.m_button == Qt::RightButton)
+    {
+      int diffX = (int)(_event.m_x - m_origXPos);
+      int diffY = (int)(_event.m_y - m_origYPos);
+      m_origXPos=_event.m_x;
+      m_origYPos=_event.m_y;
+      m_modelPos.m_x += INCREMENT * diffX;
+      m_modelPos.m_y -= INCREMENT * diffY;
+      m_mouseTXDirty=true;
+      update();
+    }
+  break;
+  case InputEventType::MOUSEPRESS :
+    // store the value where the mouse was clicked (x,y) and set the Rotate flag to true
+    if(_event.m_button == Qt::LeftButton)
+    {
+      m_origX = _event.m_x;
+      m_origY = _event.m_y;
+      m_rotate =true;
+    }
+    // right mouse translate mode
+    else if(_event.m_button == Qt::RightButton)
+    {
+      m_origXPos = _event.m_x;
+      m_origYPos = _event.m_y;
+      m_translate=true;
+    }
+  break;
+  case InputEventType::MOUSERELEASE :
+    if (_event.m_button == Qt::LeftButton)
+    {
+      m_rotate=false;
+    }
+    // right mouse translate mode
+    if (_event.m_button == Qt::RightButton)
+    {
+      m_translate=false;
+    }
+  break;
+  case InputEventType::WHEEL :
     // check the diff of the wheel position (0 means no change)
-    if(_event->delta() > 0)
+    if(_event.m_x > 0)
     {
-        m_modelPos.m_z+=ZOOM;
+      m_modelPos.m_z+=ZOOM;
     }
-    else if(_event->delta() <0 )
+    else if(_event.m_x <0 )
     {
-        m_modelPos.m_z-=ZOOM;
+      m_modelPos.m_z-=ZOOM;
     }
+    m_mouseTXDirty=true;
     update();
+  break;
+  case InputEventType::RESIZE :
+    // now set the camera size values as the screen size has changed
+    m_cam->setShape(45,(float)_event.m_x/_event.m_y,0.05,350);
+    m_cameraDirty=true;
+    update();
+  break;
+  case InputEventType::KEY :
+    switch (_event.m_x)
+    {
+    // turn on wirframe rendering
+    case Qt::Key_W : glPolygonMode(GL_FRONT_AND_BACK,GL_LINE); break;
+    // turn off wire frame
+    case Qt::Key_S : glPolygonMode(GL_FRONT_AND_BACK,GL_FILL); break;
+    // toggle the instanced cubes
+    case Qt::Key_I : m_drawInstanced^=true; m_alignmentDirty=true; break;
+    // toggle aligning the instances with the compute shader
+    case Qt::Key_C : m_alignOnGPU^=true; m_alignmentDirty=true; break;
+    // pause / resume the animation, no frames are drawn while paused unless something else changes
+    case Qt::Key_P : m_scheduler.setPaused(!m_scheduler.isPaused()); break;
+    // toggle the timing overlay
+    case Qt::Key_H : m_showHUD^=true; break;
+    default : break;
+    }
+    update();
+  break;
+  default : break;
+  }
 }
-//----------------------------------------------------------------------------------------------------------------------
-
-
 
-void NGLScene::timerEvent( QTimerEvent *_event )
+//----------------------------------------------------------------------------------------------------------------------
+void NGLScene::mouseMoveEvent (QMouseEvent * _event)
 {
-    if(_event->timerId() == m_sphereUpdateTimer)
-    {
-        if(currentTime.elapsed() > 100)//update every 100 millisecs
-        {            
-
-            testangle+=vary;
-
-
-
-
-            /////////////////////////////////////////
-            //Interpolation -back and forth motion bit
-            /////////////////////////////////////////
-            if(v1Xcoord>endLerp)
-            {
-                directionFlag=-directionFlag;
-                v1Xcoord-=directionFlag*0.1;//make sure corner cases behave correctly
-
-            }
-            if(v1Xcoord<startLerp)
-            {
-                directionFlag=-directionFlag;
-                v1Xcoord+=directionFlag*0.1;//make sure corner cases behave correctly
-            }
-
-            increment = directionFlag * increment;
-            v1Xcoord+=startLerp + increment*(endLerp-startLerp);
-
+  handleInput(InputEventType::MOUSEMOVE,_event->buttons(),_event->x(),_event->y());
+}
 
-//            v1Xcoord+=0.1;
 
+//----------------------------------------------------------------------------------------------------------------------
+void NGLScene::mousePressEvent ( QMouseEvent * _event)
+{
+  handleInput(InputEventType::MOUSEPRESS,_event->button(),_event->x(),_event->y());
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+void NGLScene::mouseReleaseEvent ( QMouseEvent * _event )
+{
+  handleInput(InputEventType::MOUSERELEASE,_event->button(),_event->x(),_event->y());
+}
 
-//            m_fps=m_frames;
-//            m_frames=0;
-            currentTime.restart();
-        }
+//----------------------------------------------------------------------------------------------------------------------
+void NGLScene::wheelEvent(QWheelEvent *_event)
+{
+  handleInput(InputEventType::WHEEL,0,_event->delta(),0);
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-        update();
 
-    }
-}
 
 void NGLScene::keyPressEvent(QKeyEvent *_event)
 {
@@ -1585,15 +1552,19 @@ void NGLScene::keyPressEvent(QKeyEvent *_event)
   {
   // escape key to quite
   case Qt::Key_Escape : QGuiApplication::exit(EXIT_SUCCESS); break;
-  // turn on wirframe rendering
-  case Qt::Key_W : glPolygonMode(GL_FRONT_AND_BACK,GL_LINE); break;
-  // turn off wire frame
-  case Qt::Key_S : glPolygonMode(GL_FRONT_AND_BACK,GL_FILL); break;
   // show full screen
-  case Qt::Key_F : showFullScreen(); break;
+  case Qt::Key_F : if(!m_inputReplayer.isActive()) { showFullScreen(); } break;
   // show windowed
-  case Qt::Key_N : showNormal(); break;
-  default : break;
+  case Qt::Key_N : if(!m_inputReplayer.isActive()) { showNormal(); } break;
+  // dump the recent frame timings
+  case Qt::Key_T :
+    if(m_profiler.writeCSV("frametimes.csv"))
+    {
+      std::cout<<"frame timings written to frametimes.csv\n";
+    }
+  break;
+  // everything that changes the scene goes through the input recorder, the window keys above do not
+  default : handleInput(InputEventType::KEY,0,_event->key(),0); break;
   }
   // finally update the GLWindow and re-draw
   //if (isExposed())
@@ -0,0 +1,120 @@
+#include "OffscreenRunner.h"
+#include "NGLScene.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+OffscreenRunner::OffscreenRunner(const QSurfaceFormat &_format, int _width, int _height)
+{
+  m_format=_format;
+  // nothing is presented so there is nothing to sync to
+  m_format.setSwapInterval(0);
+  m_width=_width;
+  m_height=_height;
+}
+
+int OffscreenRunner::run(int _frames, const QString &_imagePath)
+{
+  QOpenGLContext context;
+  context.setFormat(m_format);
+  if(!context.create())
+  {
+    std::cerr<<"OffscreenRunner : unable to create a "<<m_format.majorVersion()<<"."<<m_format.minorVersion()<<" context\n";
+    return 1;
+  }
+  QOffscreenSurface surface;
+  surface.setFormat(context.format());
+  surface.create();
+  if(!context.makeCurrent(&surface))
+  {
+    std::cerr<<"OffscreenRunner : unable to make the context current\n";
+    return 1;
+  }
+  std::cout<<"OffscreenRunner : "<<context.format().majorVersion()<<"."<<context.format().minorVersion()<<" "
+           <<reinterpret_cast<const char *>(glGetString(GL_RENDERER))<<" "<<m_width<<"x"<<m_height<<"\n";
+
+  int result=0;
+  {
+    QOpenGLFramebufferObjectFormat fboFormat;
+    fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    fboFormat.setSamples(m_format.samples());
+    QOpenGLFramebufferObject fbo(m_width,m_height,fboFormat);
+    fbo.bind();
+
+    // released explicitly below so its GL objects go while the context is still current
+    std::unique_ptr<NGLScene> scene(new NGLScene);
+    scene->resize(m_width,m_height);
+    scene->initializeGL();
+    scene->resizeGL(m_width,m_height);
+    scene->setHUDVisible(false);
+    scene->setFixedStepsPerFrame(1);
+    if(!m_replayPath.isEmpty() && !scene->replayInput(m_replayPath.toStdString()))
+    {
+      return 1;
+    }
+    scene->finishLoading();
+    glFinish();
+
+    std::vector<double> frameMs;
+    frameMs.reserve(static_cast<size_t>(_frames));
+    QElapsedTimer timer;
+    for(int i=0; _frames>0 ? i<_frames : !scene->isReplayFinished(); ++i)
+    {
+      timer.start();
+      fbo.bind();
+      scene->paintGL();
+      // wait for the GPU so each sample is the whole frame, not just the time to queue it
+      glFinish();
+      frameMs.push_back(timer.nsecsElapsed()/1000000.0);
+    }
+
+    if(!frameMs.empty())
+    {
+      std::vector<double> sorted(frameMs);
+      std::sort(sorted.begin(),sorted.end());
+      double mean=std::accumulate(sorted.begin(),sorted.end(),0.0)/sorted.size();
+      size_t p50=sorted.size()/2;
+      size_t p99=std::min(sorted.size()-1,(sorted.size()*99)/100);
+      std::cout<<"frames "<<sorted.size()<<" mean "<<mean<<" ms p50 "<<sorted[p50]<<" ms p99 "<<sorted[p99]
+               <<" ms min "<<sorted.front()<<" ms max "<<sorted.back()<<" ms\n";
+      const FrameProfiler &profiler=scene->profiler();
+      std::cout<<"cpu frame avg "<<profiler.cpuFrameStats().m_mean<<" ms p99 "<<profiler.cpuFrameStats().m_p99<<" ms\n";
+      if(profiler.gpuFrameStats().m_samples!=0)
+      {
+        std::cout<<"gpu frame avg "<<profiler.gpuFrameStats().m_mean<<" ms p99 "<<profiler.gpuFrameStats().m_p99<<" ms\n";
+      }
+      for(int s=0; s<FrameProfiler::SECTIONCOUNT; ++s)
+      {
+        FrameProfiler::Section section=static_cast<FrameProfiler::Section>(s);
+        std::cout<<"  "<<FrameProfiler::sectionName(section)<<" avg "<<profiler.sectionStats(section).m_mean
+                 <<" ms p99 "<<profiler.sectionStats(section).m_p99<<" ms\n";
+      }
+    }
+
+    if(!_imagePath.isEmpty())
+    {
+      // toImage resolves the multisampled buffer
+      if(fbo.toImage().save(_imagePath))
+      {
+        std::cout<<"wrote "<<_imagePath.toStdString()<<"\n";
+      }
+      else
+      {
+        std::cerr<<"OffscreenRunner : unable to write "<<_imagePath.toStdString()<<"\n";
+        result=1;
+      }
+    }
+    scene.reset();
+    fbo.release();
+  }
+  context.doneCurrent();
+  return result;
+}
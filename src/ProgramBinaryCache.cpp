@@ -0,0 +1,123 @@
+#include "ProgramBinaryCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+
+ProgramBinaryCache::ProgramBinaryCache()
+{
+  m_available=false;
+}
+
+void ProgramBinaryCache::init(const std::string &_directory)
+{
+  m_directory=_directory;
+  GLint major=0;
+  GLint minor=0;
+  glGetIntegerv(GL_MAJOR_VERSION,&major);
+  glGetIntegerv(GL_MINOR_VERSION,&minor);
+  GLint formats=0;
+  if(major>4 || (major==4 && minor>=1))
+  {
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+  }
+  m_available=formats>0 && QDir().mkpath(QString::fromStdString(m_directory));
+
+  for(GLenum name : {GL_VENDOR,GL_RENDERER,GL_VERSION})
+  {
+    const GLubyte *value=glGetString(name);
+    if(value!=nullptr)
+    {
+      m_driver+=reinterpret_cast<const char *>(value);
+    }
+    m_driver+='\n';
+  }
+}
+
+std::string ProgramBinaryCache::makeKey(const std::vector<std::string> &_sourcePaths) const
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(m_driver.data(),static_cast<int>(m_driver.size()));
+  for(const std::string &sourcePath : _sourcePaths)
+  {
+    QFile source(QString::fromStdString(sourcePath));
+    if(!source.open(QIODevice::ReadOnly))
+    {
+      return std::string();
+    }
+    hash.addData(source.readAll());
+  }
+  return hash.result().toHex().toStdString();
+}
+
+std::string ProgramBinaryCache::path(const std::string &_key) const
+{
+  return m_directory+"/"+_key+".bin";
+}
+
+bool ProgramBinaryCache::load(GLuint _program, const std::string &_key) const
+{
+  if(!m_available || _key.empty())
+  {
+    return false;
+  }
+  QFile file(QString::fromStdString(path(_key)));
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+  // a GLenum format followed by the binary
+  QByteArray contents=file.readAll();
+  if(contents.size()<=static_cast<int>(sizeof(GLenum)))
+  {
+    return false;
+  }
+  GLenum format;
+  std::memcpy(&format,contents.constData(),sizeof(GLenum));
+  glProgramBinary(_program,format,contents.constData()+sizeof(GLenum),contents.size()-static_cast<GLsizei>(sizeof(GLenum)));
+  GLint linked=GL_FALSE;
+  glGetProgramiv(_program,GL_LINK_STATUS,&linked);
+  if(linked!=GL_TRUE)
+  {
+    std::cerr<<"ProgramBinaryCache : binary "<<_key<<" rejected by the driver, building from source\n";
+    file.remove();
+    return false;
+  }
+  return true;
+}
+
+void ProgramBinaryCache::store(GLuint _program, const std::string &_key) const
+{
+  if(!m_available || _key.empty())
+  {
+    return;
+  }
+  GLint length=0;
+  glGetProgramiv(_program,GL_PROGRAM_BINARY_LENGTH,&length);
+  if(length<=0)
+  {
+    return;
+  }
+  QByteArray contents(static_cast<int>(sizeof(GLenum))+length,Qt::Uninitialized);
+  GLenum format=0;
+  GLsizei written=0;
+  glGetProgramBinary(_program,length,&written,&format,contents.data()+sizeof(GLenum));
+  if(written<=0)
+  {
+    return;
+  }
+  std::memcpy(contents.data(),&format,sizeof(GLenum));
+  contents.resize(static_cast<int>(sizeof(GLenum))+written);
+  // write to a temporary then rename so a crash never leaves a truncated entry behind
+  QString finalPath=QString::fromStdString(path(_key));
+  QFile file(finalPath+".tmp");
+  if(file.open(QIODevice::WriteOnly) && file.write(contents)==contents.size())
+  {
+    file.close();
+    QFile::remove(finalPath);
+    file.rename(finalPath);
+  }
+}
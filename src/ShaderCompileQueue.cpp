@@ -0,0 +1,150 @@
+#include "ShaderCompileQueue.h"
+
+#include <QOpenGLContext>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+  #define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (*MaxShaderCompilerThreadsFunc)(GLuint _count);
+
+ShaderCompileQueue::ShaderCompileQueue()
+{
+  m_parallel=false;
+}
+
+ShaderCompileQueue::~ShaderCompileQueue()
+{
+  // anything still pending is just released, the programs belong to the caller
+  for(Job &job : m_jobs)
+  {
+    for(GLuint shader : job.m_shaders)
+    {
+      glDeleteShader(shader);
+    }
+  }
+}
+
+void ShaderCompileQueue::init()
+{
+  GLint count=0;
+  glGetIntegerv(GL_NUM_EXTENSIONS,&count);
+  const char *extension=nullptr;
+  for(GLint i=0; i<count && extension==nullptr; ++i)
+  {
+    const char *name=reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS,i));
+    if(std::strcmp(name,"GL_KHR_parallel_shader_compile")==0)
+    {
+      extension="glMaxShaderCompilerThreadsKHR";
+    }
+    else if(std::strcmp(name,"GL_ARB_parallel_shader_compile")==0)
+    {
+      extension="glMaxShaderCompilerThreadsARB";
+    }
+  }
+  if(extension==nullptr)
+  {
+    return;
+  }
+  MaxShaderCompilerThreadsFunc maxThreads=reinterpret_cast<MaxShaderCompilerThreadsFunc>(
+        QOpenGLContext::currentContext()->getProcAddress(extension));
+  if(maxThreads!=nullptr)
+  {
+    // 0xFFFFFFFF lets the driver pick as many threads as it likes
+    maxThreads(0xFFFFFFFF);
+    m_parallel=true;
+  }
+}
+
+void ShaderCompileQueue::submit(const std::string &_name, GLuint _program, const std::vector<Stage> &_stages, Callback _done)
+{
+  Job job;
+  job.m_name=_name;
+  job.m_program=_program;
+  job.m_done=_done;
+  for(const Stage &stage : _stages)
+  {
+    std::ifstream file(stage.m_path);
+    if(!file.is_open())
+    {
+      std::cerr<<"ShaderCompileQueue : "<<_name<<" unable to open "<<stage.m_path<<"\n";
+    }
+    std::stringstream source;
+    source<<file.rdbuf();
+    std::string text=source.str();
+    const GLchar *code=text.c_str();
+
+    GLuint shader=glCreateShader(stage.m_type);
+    glShaderSource(shader,1,&code,nullptr);
+    // no status query here, that would wait for the compile
+    glCompileShader(shader);
+    glAttachShader(_program,shader);
+    job.m_shaders.push_back(shader);
+  }
+  glLinkProgram(_program);
+  m_jobs.push_back(std::move(job));
+}
+
+bool ShaderCompileQueue::poll()
+{
+  for(size_t i=0; i<m_jobs.size();)
+  {
+    bool done=true;
+    if(m_parallel)
+    {
+      GLint complete=GL_FALSE;
+      glGetProgramiv(m_jobs[i].m_program,GL_COMPLETION_STATUS_KHR,&complete);
+      done=complete==GL_TRUE;
+    }
+    if(!done)
+    {
+      ++i;
+      continue;
+    }
+    Job job=std::move(m_jobs[i]);
+    m_jobs.erase(m_jobs.begin()+i);
+    finish(job);
+    if(!m_parallel)
+    {
+      // without the extension finish blocks, so only take one hit per frame
+      break;
+    }
+  }
+  return isPending();
+}
+
+void ShaderCompileQueue::finish(Job &_job)
+{
+  GLint linked=GL_FALSE;
+  glGetProgramiv(_job.m_program,GL_LINK_STATUS,&linked);
+  if(linked!=GL_TRUE)
+  {
+    for(GLuint shader : _job.m_shaders)
+    {
+      GLint compiled=GL_FALSE;
+      glGetShaderiv(shader,GL_COMPILE_STATUS,&compiled);
+      if(compiled!=GL_TRUE)
+      {
+        char log[4096];
+        glGetShaderInfoLog(shader,sizeof(log),nullptr,log);
+        std::cerr<<"ShaderCompileQueue : "<<_job.m_name<<" compile failed\n"<<log<<"\n";
+      }
+    }
+    char log[4096];
+    glGetProgramInfoLog(_job.m_program,sizeof(log),nullptr,log);
+    std::cerr<<"ShaderCompileQueue : "<<_job.m_name<<" link failed\n"<<log<<"\n";
+  }
+  for(GLuint shader : _job.m_shaders)
+  {
+    glDetachShader(_job.m_program,shader);
+    glDeleteShader(shader);
+  }
+  if(_job.m_done)
+  {
+    _job.m_done(_job.m_program,linked==GL_TRUE);
+  }
+}
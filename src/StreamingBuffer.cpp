@@ -0,0 +1,151 @@
+#include "StreamingBuffer.h"
+
+#include <iostream>
+
+StreamingBuffer::StreamingBuffer()
+{
+  m_id=0;
+  m_target=GL_ARRAY_BUFFER;
+  m_regionSize=0;
+  m_persistent=false;
+  m_mapped=nullptr;
+  m_region=0;
+  for(GLsync &fence : m_fences)
+  {
+    fence=nullptr;
+  }
+  m_stalls=0;
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+  for(GLsync fence : m_fences)
+  {
+    if(fence!=nullptr)
+    {
+      glDeleteSync(fence);
+    }
+  }
+  // deleting the buffer also unmaps it
+  if(m_id!=0)
+  {
+    glDeleteBuffers(1,&m_id);
+  }
+}
+
+void StreamingBuffer::init(GLenum _target, size_t _regionSize)
+{
+  GLint major=0;
+  GLint minor=0;
+  glGetIntegerv(GL_MAJOR_VERSION,&major);
+  glGetIntegerv(GL_MINOR_VERSION,&minor);
+  m_persistent= major>4 || (major==4 && minor>=4);
+  m_target=_target;
+  // 256 covers the uniform, storage and vertex offset alignment of every implementation
+  const size_t alignment=256;
+  m_regionSize=(_regionSize+alignment-1)/alignment*alignment;
+  // the first beginWrite moves on to region 0, the fallback only has the one
+  m_region= m_persistent ? REGION_COUNT-1 : 0;
+
+  glGenBuffers(1,&m_id);
+  glBindBuffer(m_target,m_id);
+  if(m_persistent)
+  {
+    const GLbitfield flags=GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size=static_cast<GLsizeiptr>(REGION_COUNT*m_regionSize);
+    // drop any error left by earlier calls so the check below is about the storage
+    while(glGetError()!=GL_NO_ERROR)
+    {
+    }
+    glBufferStorage(m_target,size,nullptr,flags);
+    GLenum error=glGetError();
+    if(error==GL_NO_ERROR)
+    {
+      m_mapped=static_cast<unsigned char *>(glMapBufferRange(m_target,0,size,flags));
+    }
+    if(m_mapped==nullptr)
+    {
+      std::cerr<<"StreamingBuffer : persistent "<<(error==GL_NO_ERROR ? "mapping" : "storage")
+               <<" failed, mapping each frame instead\n";
+      // immutable storage can not be given again, the fallback needs a fresh buffer
+      glBindBuffer(m_target,0);
+      glDeleteBuffers(1,&m_id);
+      m_persistent=false;
+      m_region=0;
+      glGenBuffers(1,&m_id);
+      glBindBuffer(m_target,m_id);
+      glBufferData(m_target,static_cast<GLsizeiptr>(m_regionSize),nullptr,GL_STREAM_DRAW);
+    }
+  }
+  else
+  {
+    std::cerr<<"StreamingBuffer : persistent mapping needs GL 4.4, context is "<<major<<"."<<minor
+             <<" mapping each frame instead\n";
+    glBufferData(m_target,static_cast<GLsizeiptr>(m_regionSize),nullptr,GL_STREAM_DRAW);
+  }
+  glBindBuffer(m_target,0);
+}
+
+void *StreamingBuffer::beginWrite()
+{
+  if(!m_persistent)
+  {
+    // invalidating lets the driver hand us fresh storage while draws still read the old
+    glBindBuffer(m_target,m_id);
+    void *mapped=glMapBufferRange(m_target,0,static_cast<GLsizeiptr>(m_regionSize),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(mapped==nullptr)
+    {
+      glBindBuffer(m_target,0);
+    }
+    return mapped;
+  }
+
+  m_region=(m_region+1)%REGION_COUNT;
+  GLsync &fence=m_fences[m_region];
+  if(fence!=nullptr)
+  {
+    GLenum status=glClientWaitSync(fence,0,0);
+    if(status==GL_TIMEOUT_EXPIRED)
+    {
+      ++m_stalls;
+      // flush so the fence is sure to be reached, then wait in 1ms steps
+      do
+      {
+        status=glClientWaitSync(fence,GL_SYNC_FLUSH_COMMANDS_BIT,1000000);
+      }
+      while(status==GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence=nullptr;
+  }
+  return m_mapped+m_region*m_regionSize;
+}
+
+bool StreamingBuffer::endWrite()
+{
+  // the persistent mapping is coherent so the writes are seen by every command issued after this
+  if(m_persistent)
+  {
+    return true;
+  }
+  // false when the store was lost while mapped (a mode switch for instance), its contents are undefined
+  GLboolean intact=glUnmapBuffer(m_target);
+  glBindBuffer(m_target,0);
+  return intact==GL_TRUE;
+}
+
+void StreamingBuffer::fence()
+{
+  if(!m_persistent)
+  {
+    return;
+  }
+  // only the latest draws reading the region matter
+  GLsync &fence=m_fences[m_region];
+  if(fence!=nullptr)
+  {
+    glDeleteSync(fence);
+  }
+  fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+}
@@ -0,0 +1,101 @@
+#include "Tracer.h"
+
+#include <iostream>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief ring size in events (2MB), several seconds of frames even if the drain thread is descheduled
+//----------------------------------------------------------------------------------------------------------------------
+const static size_t TRACE_RING_EVENTS=1<<16;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief events moved from the ring per fwrite
+//----------------------------------------------------------------------------------------------------------------------
+const static size_t TRACE_DRAIN_BATCH=1024;
+
+Tracer &Tracer::instance()
+{
+  static Tracer s_instance;
+  return s_instance;
+}
+
+Tracer::Tracer() : m_ring(TRACE_RING_EVENTS)
+{
+  m_enabled.store(false);
+  m_running.store(false);
+  m_file=nullptr;
+  m_startTime=std::chrono::steady_clock::now();
+}
+
+Tracer::~Tracer()
+{
+  stop();
+}
+
+bool Tracer::start(const std::string &_path)
+{
+  if(m_file!=nullptr)
+  {
+    return true;
+  }
+  m_file=std::fopen(_path.c_str(),"wb");
+  if(m_file==nullptr)
+  {
+    std::cerr<<"Tracer : unable to open "<<_path<<"\n";
+    return false;
+  }
+  const char magic[4]={'R','T','R','C'};
+  const uint32_t version=1;
+  std::fwrite(magic,1,sizeof(magic),m_file);
+  std::fwrite(&version,sizeof(version),1,m_file);
+
+  m_startTime=std::chrono::steady_clock::now();
+  m_running.store(true);
+  m_thread=std::thread(&Tracer::drain,this);
+  m_enabled.store(true,std::memory_order_release);
+  return true;
+}
+
+void Tracer::stop()
+{
+  if(m_file==nullptr)
+  {
+    return;
+  }
+  m_enabled.store(false);
+  m_running.store(false);
+  if(m_thread.joinable())
+  {
+    m_thread.join();
+  }
+  flush();
+  std::fclose(m_file);
+  m_file=nullptr;
+  if(m_ring.dropped()!=0)
+  {
+    std::cerr<<"Tracer : "<<m_ring.dropped()<<" events dropped, the ring was full\n";
+  }
+}
+
+size_t Tracer::flush()
+{
+  TraceEvent batch[TRACE_DRAIN_BATCH];
+  size_t total=0;
+  size_t count;
+  while((count=m_ring.pop(batch,TRACE_DRAIN_BATCH))!=0)
+  {
+    std::fwrite(batch,sizeof(TraceEvent),count,m_file);
+    total+=count;
+  }
+  return total;
+}
+
+void Tracer::drain()
+{
+  while(m_running.load())
+  {
+    if(flush()==0)
+    {
+      // nothing to do, a frame is at least a few milliseconds so polling at this rate keeps the ring short
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#include "UniformBlockBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+void FrameBlock::set(const ngl::Mat4 &_V, const ngl::Mat4 &_VP, const ngl::Vec3 &_eye)
+{
+  std::memcpy(m_V,&_V.m_m[0][0],sizeof(m_V));
+  std::memcpy(m_VP,&_VP.m_m[0][0],sizeof(m_VP));
+  m_viewerPos[0]=_eye.m_x;
+  m_viewerPos[1]=_eye.m_y;
+  m_viewerPos[2]=_eye.m_z;
+  m_viewerPos[3]=1.0f;
+}
+
+void TransformBlock::set(const ngl::Mat4 &_M, const ngl::Mat4 &_MV, const ngl::Mat4 &_MVP, const ngl::Mat3 &_normalMatrix)
+{
+  std::memcpy(m_M,&_M.m_m[0][0],sizeof(m_M));
+  std::memcpy(m_MV,&_MV.m_m[0][0],sizeof(m_MV));
+  std::memcpy(m_MVP,&_MVP.m_m[0][0],sizeof(m_MVP));
+  // std140 mat3 is three vec4 aligned columns
+  for(int c=0; c<3; ++c)
+  {
+    m_normalMatrix[c*4+0]=_normalMatrix.m_m[c][0];
+    m_normalMatrix[c*4+1]=_normalMatrix.m_m[c][1];
+    m_normalMatrix[c*4+2]=_normalMatrix.m_m[c][2];
+    m_normalMatrix[c*4+3]=0.0f;
+  }
+}
+
+static void setColour(GLfloat *o_dest, const ngl::Colour &_colour)
+{
+  o_dest[0]=_colour.m_r;
+  o_dest[1]=_colour.m_g;
+  o_dest[2]=_colour.m_b;
+  o_dest[3]=_colour.m_a;
+}
+
+void MaterialBlock::set(const ngl::Material &_material)
+{
+  setColour(m_ambient,_material.getAmbient());
+  setColour(m_diffuse,_material.getDiffuse());
+  setColour(m_specular,_material.getSpecular());
+  m_shininess=_material.getSpecularExponent();
+  m_pad[0]=m_pad[1]=m_pad[2]=0.0f;
+}
+
+UniformBlockBuffer::UniformBlockBuffer()
+{
+  m_id=0;
+  m_binding=0;
+  m_blockSize=0;
+  m_stride=0;
+  m_count=0;
+  m_dirty=false;
+  m_gpuCapacity=0;
+}
+
+UniformBlockBuffer::~UniformBlockBuffer()
+{
+  if(m_id!=0)
+  {
+    glDeleteBuffers(1,&m_id);
+  }
+}
+
+void UniformBlockBuffer::init(GLuint _binding, size_t _blockSize, size_t _capacity)
+{
+  GLint alignment=256;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+  m_binding=_binding;
+  m_blockSize=_blockSize;
+  m_stride=(_blockSize+alignment-1)/alignment*alignment;
+  m_count=0;
+  m_gpuCapacity=_capacity;
+  m_staging.resize(m_stride*_capacity);
+
+  glGenBuffers(1,&m_id);
+  glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferData(GL_UNIFORM_BUFFER,m_gpuCapacity*m_stride,nullptr,GL_STREAM_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+}
+
+size_t UniformBlockBuffer::push(const void *_block)
+{
+  if((m_count+1)*m_stride>m_staging.size())
+  {
+    m_staging.resize(m_staging.size()*2+m_stride);
+  }
+  std::memcpy(&m_staging[m_count*m_stride],_block,m_blockSize);
+  m_dirty=true;
+  return m_count++;
+}
+
+void UniformBlockBuffer::set(size_t _slot, const void *_block)
+{
+  if((_slot+1)*m_stride>m_staging.size())
+  {
+    m_staging.resize((_slot+1)*m_stride);
+  }
+  std::memcpy(&m_staging[_slot*m_stride],_block,m_blockSize);
+  m_count=std::max(m_count,_slot+1);
+  m_dirty=true;
+}
+
+void UniformBlockBuffer::upload()
+{
+  if(m_count==0 || !m_dirty)
+  {
+    return;
+  }
+  m_dirty=false;
+  glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+  if(m_count>m_gpuCapacity)
+  {
+    m_gpuCapacity=m_staging.size()/m_stride;
+  }
+  // orphan the old storage so we don't wait on draws still reading it
+  glBufferData(GL_UNIFORM_BUFFER,m_gpuCapacity*m_stride,nullptr,GL_STREAM_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER,0,m_count*m_stride,&m_staging[0]);
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+}
+
+void UniformBlockBuffer::bind(size_t _slot) const
+{
+  glBindBufferRange(GL_UNIFORM_BUFFER,m_binding,m_id,_slot*m_stride,m_blockSize);
+}
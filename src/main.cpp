@@ -4,14 +4,38 @@ basic OpenGL demo modified from http://qt-project.org/doc/qt-5.0/qtgui/openglwin
 #include "OpenGLWindow.h"
 
 #include <QtGui/QGuiApplication>
+#include <QCommandLineParser>
+#include <QStringList>
 #include <iostream>
 #include "NGLScene.h"
+#include "OffscreenRunner.h"
+#include "Tracer.h"
 
 
 
 int main(int argc, char **argv)
 {
   QGuiApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  QCommandLineOption traceOption("trace","write a binary frame trace (see Tracer.h) to <file>","file");
+  parser.addOption(traceOption);
+  QCommandLineOption offscreenOption("offscreen","draw <frames> frames with no window and print the timings","frames");
+  parser.addOption(offscreenOption);
+  QCommandLineOption outputOption("output","with --offscreen write the last frame to <image>","image");
+  parser.addOption(outputOption);
+  QCommandLineOption sizeOption("size","framebuffer size for --offscreen (default 1024x720)","WxH","1024x720");
+  parser.addOption(sizeOption);
+  QCommandLineOption recordOption("record","record the input and animation steps to <file>","file");
+  parser.addOption(recordOption);
+  QCommandLineOption replayOption("replay","replay a --record file as fast as possible then quit, with --offscreen 0 "
+                                           "the frame count is taken from the recording","file");
+  parser.addOption(replayOption);
+  parser.process(app);
+  if(parser.isSet(traceOption))
+  {
+    Tracer::instance().start(parser.value(traceOption).toStdString());
+  }
   // create an OpenGL format specifier
   QSurfaceFormat format;
   // set the number of samples for multisampling
@@ -31,18 +55,71 @@ int main(int argc, char **argv)
   format.setProfile(QSurfaceFormat::CoreProfile);
   // now set the depth buffer to 24 bits
   format.setDepthBufferSize(24);
-  // now we are going to create our scene window
-  NGLScene window;
-  // and set the OpenGL format
-  window.setFormat(format);
-  // we can now query the version to see if it worked
-  std::cout<<"Profile is "<<format.majorVersion()<<" "<<format.minorVersion()<<"\n";
-  // set the window size
-  window.resize(1024, 720);
-  // and finally show
-  window.show();
-
-  return app.exec();
+  // sync swaps to the display refresh so the scene never draws faster than it can be shown
+  format.setSwapInterval(1);
+  if(parser.isSet(replayOption))
+  {
+    // replays are timed, don't wait for the display
+    format.setSwapInterval(0);
+  }
+
+  if(parser.isSet(recordOption) && parser.isSet(offscreenOption))
+  {
+    std::cerr<<"--record needs live input, it can't be used with --offscreen\n";
+    return 1;
+  }
+
+  int result=0;
+  if(parser.isSet(offscreenOption))
+  {
+    bool framesOk=false;
+    int frames=parser.value(offscreenOption).toInt(&framesOk);
+    QStringList size=parser.value(sizeOption).split('x');
+    int width=size.size()==2 ? size[0].toInt() : 0;
+    int height=size.size()==2 ? size[1].toInt() : 0;
+    if(!framesOk || frames<0 || (frames==0 && !parser.isSet(replayOption)) || width<1 || height<1)
+    {
+      std::cerr<<"--offscreen needs a frame count and --size WxH\n";
+      result=1;
+    }
+    else
+    {
+      OffscreenRunner runner(format,width,height);
+      runner.setReplay(parser.value(replayOption));
+      result=runner.run(frames,parser.value(outputOption));
+    }
+  }
+  else
+  {
+    // now we are going to create our scene window
+    NGLScene window;
+    if(parser.isSet(recordOption) && !window.recordInput(parser.value(recordOption).toStdString()))
+    {
+      return 1;
+    }
+    if(parser.isSet(replayOption) && !window.replayInput(parser.value(replayOption).toStdString()))
+    {
+      return 1;
+    }
+    // and set the OpenGL format
+    window.setFormat(format);
+    // we can now query the version to see if it worked
+    std::cout<<"Profile is "<<format.majorVersion()<<" "<<format.minorVersion()<<"\n";
+    // set the window size, a replay keeps it
+    window.resize(1024, 720);
+    if(parser.isSet(replayOption))
+    {
+      window.setMinimumSize(QSize(1024,720));
+      window.setMaximumSize(QSize(1024,720));
+    }
+    // and finally show
+    window.show();
+
+    result=app.exec();
+  }
+  // write out whatever is still queued in the trace ring
+  Tracer::instance().stop();
+  return result;
 }
 
 
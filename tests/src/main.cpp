@@ -0,0 +1,638 @@
+/****************************************************************************
+rottest : unit tests for the rotationmath library and the GL free parts of the
+demo, prints every failed check and exits non zero if there were any
+
+  batch        rotationBetweenVectorsBatch is bit identical to the scalar
+               rotationBetweenVectors, antiparallel and identical pairs and
+               the scalar tail included
+  transforms   TransformStore create / destroy / isValid and handle reuse
+  jobs         JobSystem::parallelFor runs every index of [0,count) once
+  drawQueue    DrawQueue sort order and the state changes submit skips
+  animation    AnimationSet::sample on one thread and on a JobSystem against a
+               per track scalar evaluation, on, between and outside the keys
+  cull         cullSpheres against a per sphere scalar plane test, spheres inside,
+               outside and straddling each plane, a NaN radius and a scalar tail
+  trig         every FastTrig tier, scalar and array, within the error bounds FastTrig.h
+               states and NaN in giving NaN out
+****************************************************************************/
+#include "Animation.h"
+#include "DrawQueue.h"
+#include "FastTrig.h"
+#include "FrustumCull.h"
+#include "JobSystem.h"
+#include "RotationBatch.h"
+#include "RotationMath.h"
+#include "TransformStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+int s_checks=0;
+int s_failures=0;
+
+void check(bool _ok, const char *_what, const char *_file, int _line)
+{
+  ++s_checks;
+  if(!_ok)
+  {
+    ++s_failures;
+    std::cerr<<_file<<":"<<_line<<" failed : "<<_what<<"\n";
+  }
+}
+
+#define CHECK(_expr) check((_expr),#_expr,__FILE__,__LINE__)
+
+bool sameBits(float _a, float _b)
+{
+  return std::memcmp(&_a,&_b,sizeof(float))==0;
+}
+
+void testBatch()
+{
+  std::vector<rmath::Vec3> starts;
+  std::vector<rmath::Vec3> dests;
+  // the cases the fallbacks are for, including a start along z so the generated axis has to be picked again
+  const rmath::Vec3 axes[]={rmath::Vec3(1.0f,0.0f,0.0f),rmath::Vec3(0.0f,1.0f,0.0f),rmath::Vec3(0.0f,0.0f,1.0f),
+                            rmath::Vec3(0.3f,-0.5f,0.8f)};
+  for(const rmath::Vec3 &axis : axes)
+  {
+    starts.push_back(axis);
+    dests.push_back(axis);
+    starts.push_back(axis);
+    dests.push_back(rmath::Vec3(-axis.m_x,-axis.m_y,-axis.m_z));
+    starts.push_back(rmath::Vec3(-axis.m_x,-axis.m_y,-axis.m_z));
+    dests.push_back(axis);
+    // not normalized, the same direction
+    starts.push_back(axis);
+    dests.push_back(rmath::Vec3(axis.m_x*3.0f,axis.m_y*3.0f,axis.m_z*3.0f));
+  }
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> uniform(-1.0f,1.0f);
+  std::uniform_real_distribution<float> tiny(-1.0e-4f,1.0e-4f);
+  for(int i=0; i<1000; ++i)
+  {
+    rmath::Vec3 s(uniform(rng),uniform(rng),uniform(rng)+2.0f);
+    starts.push_back(s);
+    switch(i%3)
+    {
+      case 0 : dests.push_back(rmath::Vec3(uniform(rng),uniform(rng),uniform(rng)-2.0f)); break;
+      case 1 : dests.push_back(rmath::Vec3(s.m_x+tiny(rng),s.m_y+tiny(rng),s.m_z+tiny(rng))); break;
+      default : dests.push_back(rmath::Vec3(-s.m_x+tiny(rng),-s.m_y+tiny(rng),-s.m_z+tiny(rng))); break;
+    }
+  }
+  // an odd count so the batch kernel finishes on its scalar tail
+  starts.push_back(rmath::Vec3(0.0f,0.0f,-1.0f));
+  dests.push_back(rmath::Vec3(0.0f,0.0f,1.0f));
+
+  const size_t count=starts.size();
+  std::vector<float> in(count*6);
+  std::vector<float> out(count*4);
+  for(size_t i=0; i<count; ++i)
+  {
+    in[i]=starts[i].m_x;
+    in[count+i]=starts[i].m_y;
+    in[2*count+i]=starts[i].m_z;
+    in[3*count+i]=dests[i].m_x;
+    in[4*count+i]=dests[i].m_y;
+    in[5*count+i]=dests[i].m_z;
+  }
+  rmath::rotationBetweenVectorsBatch({&in[0],&in[count],&in[2*count]},{&in[3*count],&in[4*count],&in[5*count]},
+                                     {&out[0],&out[count],&out[2*count],&out[3*count]},count);
+  size_t different=0;
+  for(size_t i=0; i<count; ++i)
+  {
+    rmath::Quaternion q=rmath::rotationBetweenVectors(starts[i],dests[i]);
+    if(!sameBits(q.m_s,out[i]) || !sameBits(q.m_x,out[count+i]) || !sameBits(q.m_y,out[2*count+i]) ||
+       !sameBits(q.m_z,out[3*count+i]))
+    {
+      ++different;
+    }
+  }
+  CHECK(different==0);
+
+  // the identical and antiparallel results themselves
+  rmath::Quaternion same=rmath::rotationBetweenVectors(rmath::Vec3(0.0f,1.0f,0.0f),rmath::Vec3(0.0f,1.0f,0.0f));
+  CHECK(same.m_s==1.0f && same.m_x==0.0f && same.m_y==0.0f && same.m_z==0.0f);
+  rmath::Quaternion half=rmath::rotationBetweenVectors(rmath::Vec3(0.0f,0.0f,1.0f),rmath::Vec3(0.0f,0.0f,-1.0f));
+  CHECK(std::abs(half.m_s)<1.0e-6f);
+  CHECK(std::abs(half.m_x*half.m_x+half.m_y*half.m_y+half.m_z*half.m_z-1.0f)<1.0e-6f);
+  CHECK(half.m_z==0.0f);
+}
+
+void testTransforms()
+{
+  rmath::TransformStore store;
+  rmath::TransformHandle a=store.create(rmath::Vec3(1.0f,0.0f,0.0f));
+  rmath::TransformHandle b=store.create(rmath::Vec3(2.0f,0.0f,0.0f));
+  rmath::TransformHandle c=store.create(rmath::Vec3(3.0f,0.0f,0.0f));
+  CHECK(store.size()==3);
+  CHECK(store.isValid(a) && store.isValid(b) && store.isValid(c));
+
+  // the last transform moves into the hole and keeps its data
+  store.destroy(a);
+  CHECK(!store.isValid(a));
+  CHECK(store.isValid(b) && store.isValid(c));
+  CHECK(store.size()==2);
+  CHECK(store.indexOf(c)==0);
+  CHECK(store.position(c).m_x==3.0f);
+  CHECK(store.position(b).m_x==2.0f);
+  CHECK(store.handleAt(store.indexOf(b)).m_slot==b.m_slot);
+
+  // a reused slot does not bring the old handle back
+  rmath::TransformHandle d=store.create(rmath::Vec3(4.0f,0.0f,0.0f));
+  CHECK(store.isValid(d));
+  CHECK(!store.isValid(a));
+  CHECK(store.size()==3);
+  CHECK(store.position(d).m_x==4.0f);
+
+  store.clear();
+  CHECK(store.size()==0);
+  CHECK(!store.isValid(b) && !store.isValid(c) && !store.isValid(d));
+  rmath::TransformHandle e=store.create();
+  CHECK(store.isValid(e));
+  CHECK(!store.isValid(b) && !store.isValid(c) && !store.isValid(d));
+}
+
+void testJobs()
+{
+  rmath::JobSystem jobs(4);
+  const size_t counts[]={0,1,63,64,65,1000,100003};
+  const size_t grains[]={1,8,64};
+  for(size_t grain : grains)
+  {
+    for(size_t count : counts)
+    {
+      std::vector<std::atomic<int>> hits(count);
+      for(std::atomic<int> &hit : hits)
+      {
+        hit=0;
+      }
+      std::atomic<bool> aligned(true);
+      jobs.parallelFor(count,grain,[&](size_t _begin, size_t _end)
+      {
+        if(_begin%grain!=0 || (_end%grain!=0 && _end!=count))
+        {
+          aligned=false;
+        }
+        for(size_t i=_begin; i<_end; ++i)
+        {
+          ++hits[i];
+        }
+      });
+      bool once=true;
+      for(const std::atomic<int> &hit : hits)
+      {
+        once=once && hit==1;
+      }
+      CHECK(once);
+      CHECK(aligned);
+    }
+  }
+}
+
+void testDrawQueue()
+{
+  std::mt19937 rng(99);
+  std::uniform_int_distribution<uint32_t> small(0,3);
+  std::uniform_real_distribution<float> depth(-50.0f,50.0f);
+  DrawQueue queue;
+  queue.reserve(500);
+  std::vector<uint64_t> keys;
+  for(uint32_t i=0; i<500; ++i)
+  {
+    uint32_t program=small(rng);
+    uint32_t material=small(rng);
+    uint32_t mesh=small(rng);
+    float z=depth(rng);
+    queue.push(program,material,mesh,z,i);
+    keys.push_back(DrawQueue::makeKey(program,material,mesh,z));
+  }
+  queue.sort();
+  CHECK(queue.size()==500);
+  // the same keys in ascending order, each still carrying its own draw
+  std::vector<uint64_t> sorted=keys;
+  std::sort(sorted.begin(),sorted.end());
+  bool ordered=true;
+  std::vector<int> seen(keys.size(),0);
+  for(size_t i=0; i<queue.size(); ++i)
+  {
+    uint32_t draw=queue[i].m_transform;
+    ordered=ordered && queue[i].m_key==sorted[i] && draw<keys.size() && queue[i].m_key==keys[draw];
+    if(draw<keys.size())
+    {
+      ++seen[draw];
+    }
+  }
+  CHECK(ordered);
+  CHECK(std::count(seen.begin(),seen.end(),1)==static_cast<long>(seen.size()));
+
+  // nearest first within a program / material / mesh group, negative depths included
+  DrawQueue depths;
+  const float zs[]={3.0f,-2.0f,0.5f,-0.0f,10.0f};
+  for(uint32_t i=0; i<5; ++i)
+  {
+    depths.push(1,1,1,zs[i],i);
+  }
+  depths.sort();
+  const uint32_t expected[]={1,3,2,0,4};
+  bool nearestFirst=true;
+  for(uint32_t i=0; i<5; ++i)
+  {
+    nearestFirst=nearestFirst && depths[i].m_transform==expected[i];
+  }
+  CHECK(nearestFirst);
+
+  // three draws of one program, material and mesh set the state once
+  size_t calls=0;
+  size_t draws=0;
+  DrawQueue::Backend backend;
+  backend.m_useProgram=[&](uint32_t){ ++calls; };
+  backend.m_useMaterial=[&](uint32_t){ ++calls; };
+  backend.m_bindMesh=[&](uint32_t){ ++calls; };
+  backend.m_draw=[&](const DrawQueue::Item &){ ++draws; };
+  DrawQueue shared;
+  for(uint32_t i=0; i<3; ++i)
+  {
+    shared.push(2,5,7,static_cast<float>(i),i);
+  }
+  shared.sort();
+  const DrawQueue::Stats &stats=shared.submit(backend);
+  CHECK(draws==3);
+  CHECK(calls==3);
+  CHECK(stats.m_draws==3 && stats.m_stateChanges==3 && stats.m_skipped==6);
+
+  // a new program resets the material even when its id is the same, the mesh carries over
+  calls=0;
+  draws=0;
+  DrawQueue mixed;
+  mixed.push(0,1,4,1.0f,0);
+  mixed.push(0,1,4,2.0f,1);
+  mixed.push(0,2,4,1.0f,2);
+  mixed.push(1,2,4,1.0f,3);
+  mixed.sort();
+  const DrawQueue::Stats &mixedStats=mixed.submit(backend);
+  // first draw 3, material change 1, program change 2 (program and material)
+  CHECK(draws==4);
+  CHECK(mixedStats.m_stateChanges==6 && calls==6);
+  CHECK(mixedStats.m_skipped==6);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the pose of one track worked out directly from its keys, the scalar reference for AnimationSet::sample
+//----------------------------------------------------------------------------------------------------------------------
+template<typename K>
+size_t bracket(const std::vector<K> &_keys, float _time, size_t &o_next, float &o_t)
+{
+  o_t=0.0f;
+  if(_time<=_keys.front().m_time)
+  {
+    o_next=0;
+    return 0;
+  }
+  if(_time>=_keys.back().m_time)
+  {
+    o_next=_keys.size()-1;
+    return o_next;
+  }
+  size_t key=0;
+  while(_keys[key+1].m_time<=_time)
+  {
+    ++key;
+  }
+  o_next=key+1;
+  o_t=(_time-_keys[key].m_time)/(_keys[key+1].m_time-_keys[key].m_time);
+  return key;
+}
+
+void testAnimation()
+{
+  std::mt19937 rng(777);
+  std::normal_distribution<float> normal;
+  std::uniform_int_distribution<int> keyCount(1,5);
+  std::uniform_real_distribution<float> gap(0.25f,2.0f);
+  // not a multiple of the sample block or the SIMD width, so the last block is partial
+  const size_t trackCount=203;
+  std::vector<std::vector<rmath::PositionKey>> positions(trackCount);
+  std::vector<std::vector<rmath::RotationKey>> rotations(trackCount);
+  rmath::AnimationSet set;
+  std::vector<float> times;
+  for(size_t track=0; track<trackCount; ++track)
+  {
+    float time=gap(rng)-1.0f;
+    for(int k=keyCount(rng); k>0; --k)
+    {
+      positions[track].push_back({time,rmath::Vec3(normal(rng),normal(rng),normal(rng))});
+      times.push_back(time);
+      time+=gap(rng);
+    }
+    time=gap(rng)-1.0f;
+    for(int k=keyCount(rng); k>0; --k)
+    {
+      rmath::Quaternion q(normal(rng),normal(rng),normal(rng),normal(rng));
+      float len=std::sqrt(q.m_s*q.m_s+q.m_x*q.m_x+q.m_y*q.m_y+q.m_z*q.m_z);
+      rotations[track].push_back({time,rmath::Quaternion(q.m_s/len,q.m_x/len,q.m_y/len,q.m_z/len)});
+      times.push_back(time);
+      time+=gap(rng);
+    }
+    set.addTrack(positions[track],rotations[track]);
+  }
+  CHECK(set.trackCount()==trackCount);
+  // on the keys, between them and before / after every track
+  const size_t keyTimes=times.size();
+  for(size_t i=0; i+1<keyTimes; i+=7)
+  {
+    times.push_back(0.5f*(times[i]+times[i+1]));
+  }
+  times.push_back(-100.0f);
+  times.push_back(set.duration());
+  times.push_back(set.duration()+100.0f);
+
+  rmath::JobSystem jobs(4);
+  std::vector<float> single(trackCount*7);
+  std::vector<float> threaded(trackCount*7);
+  const rmath::PoseStream singleOut={&single[0],&single[trackCount],&single[2*trackCount],
+                                     {&single[3*trackCount],&single[4*trackCount],&single[5*trackCount],
+                                      &single[6*trackCount]}};
+  const rmath::PoseStream threadedOut={&threaded[0],&threaded[trackCount],&threaded[2*trackCount],
+                                       {&threaded[3*trackCount],&threaded[4*trackCount],&threaded[5*trackCount],
+                                        &threaded[6*trackCount]}};
+  size_t positionMismatches=0;
+  size_t nlerpMismatches=0;
+  size_t slerpMismatches=0;
+  size_t threadMismatches=0;
+  for(rmath::RotationInterpolation mode : {rmath::RotationInterpolation::NLERP,rmath::RotationInterpolation::SLERP})
+  {
+    for(float time : times)
+    {
+      set.sample(time,singleOut,mode);
+      set.sample(time,threadedOut,mode,&jobs);
+      threadMismatches+= std::memcmp(&single[0],&threaded[0],single.size()*sizeof(float))!=0;
+      for(size_t track=0; track<trackCount; ++track)
+      {
+        size_t next;
+        float t;
+        const std::vector<rmath::PositionKey> &p=positions[track];
+        size_t key=bracket(p,time,next,t);
+        const rmath::Vec3 &a=p[key].m_value;
+        const rmath::Vec3 &b=p[next].m_value;
+        positionMismatches+= !sameBits(singleOut.m_x[track],a.m_x+(b.m_x-a.m_x)*t) ||
+                             !sameBits(singleOut.m_y[track],a.m_y+(b.m_y-a.m_y)*t) ||
+                             !sameBits(singleOut.m_z[track],a.m_z+(b.m_z-a.m_z)*t);
+
+        const std::vector<rmath::RotationKey> &r=rotations[track];
+        key=bracket(r,time,next,t);
+        rmath::Quaternion sampled(singleOut.m_rotation.m_s[track],singleOut.m_rotation.m_x[track],
+                                  singleOut.m_rotation.m_y[track],singleOut.m_rotation.m_z[track]);
+        if(mode==rmath::RotationInterpolation::NLERP)
+        {
+          // the batched nlerp issues rmath::nlerp's operations in the same order
+          rmath::Quaternion q=rmath::nlerp(r[key].m_value,r[next].m_value,t);
+          nlerpMismatches+= !sameBits(sampled.m_s,q.m_s) || !sameBits(sampled.m_x,q.m_x) ||
+                            !sameBits(sampled.m_y,q.m_y) || !sameBits(sampled.m_z,q.m_z);
+        }
+        else
+        {
+          // the approximated slerp is within 1.5e-3 radians of the exact one (Animation.h)
+          rmath::Quaternion q=rmath::slerp(r[key].m_value,r[next].m_value,t);
+          double d=std::fabs(static_cast<double>(sampled.m_s)*q.m_s+static_cast<double>(sampled.m_x)*q.m_x+
+                             static_cast<double>(sampled.m_y)*q.m_y+static_cast<double>(sampled.m_z)*q.m_z);
+          double angle=2.0*std::acos(std::min(1.0,d));
+          slerpMismatches+= !(angle<1.5e-3);
+        }
+      }
+    }
+  }
+  CHECK(positionMismatches==0);
+  CHECK(nlerpMismatches==0);
+  CHECK(slerpMismatches==0);
+  CHECK(threadMismatches==0);
+}
+
+void testCull()
+{
+  // 45 degree perspective looking down -z, as the demo camera, in the row vector (ngl) layout
+  const float f=1.0f/std::tan(22.5f*static_cast<float>(M_PI)/180.0f);
+  const float nearPlane=0.05f;
+  const float farPlane=350.0f;
+  rmath::Mat4 project;
+  project.m_m[0][0]=f/1.25f;
+  project.m_m[1][1]=f;
+  project.m_m[2][2]=(farPlane+nearPlane)/(nearPlane-farPlane);
+  project.m_m[2][3]=-1.0f;
+  project.m_m[3][2]=2.0f*farPlane*nearPlane/(nearPlane-farPlane);
+  project.m_m[3][3]=0.0f;
+  rmath::Frustum frustum=rmath::frustumFromMatrix(project);
+  bool unitNormals=true;
+  for(const float *plane : frustum.m_planes)
+  {
+    unitNormals=unitNormals && std::fabs(plane[0]*plane[0]+plane[1]*plane[1]+plane[2]*plane[2]-1.0f)<1.0e-5f;
+  }
+  CHECK(unitNormals);
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> r;
+  auto add=[&](float _x, float _y, float _z, float _r)
+  {
+    x.push_back(_x);
+    y.push_back(_y);
+    z.push_back(_z);
+    r.push_back(_r);
+  };
+  // pushed out through each plane from a point well inside : wholly inside, straddling, touching and wholly outside
+  const float inside[3]={0.0f,0.0f,-20.0f};
+  for(const float *plane : frustum.m_planes)
+  {
+    float distance=plane[0]*inside[0]+plane[1]*inside[1]+plane[2]*inside[2]+plane[3];
+    for(float radius : {0.5f,2.0f})
+    {
+      for(float offset : {-1.5f,-0.5f,0.5f,1.0f,1.5f})
+      {
+        // the centre ends up offset * radius outside the plane
+        float move=distance+offset*radius;
+        add(inside[0]-plane[0]*move,inside[1]-plane[1]*move,inside[2]-plane[2]*move,radius);
+      }
+    }
+  }
+  const size_t nanSphere=x.size();
+  add(inside[0],inside[1],inside[2],std::numeric_limits<float>::quiet_NaN());
+  std::mt19937 rng(31);
+  std::uniform_real_distribution<float> position(-60.0f,60.0f);
+  std::uniform_real_distribution<float> radius(0.0f,5.0f);
+  for(int i=0; i<500; ++i)
+  {
+    add(position(rng),position(rng),position(rng)-40.0f,radius(rng));
+  }
+  // leave a scalar tail whatever the SIMD width
+  while(x.size()%8!=5)
+  {
+    add(position(rng),position(rng),position(rng),radius(rng));
+  }
+
+  const size_t count=x.size();
+  for(size_t begin : {static_cast<size_t>(0),static_cast<size_t>(3)})
+  {
+    // exactly the room the header asks for, so a write past it is caught by the sanitizers
+    std::vector<uint32_t> visible(count-begin);
+    size_t written=rmath::cullSpheres(frustum,{&x[0],&y[0],&z[0]},&r[0],begin,count,&visible[0]);
+    size_t mismatches=0;
+    size_t next=0;
+    for(size_t i=begin; i<count; ++i)
+    {
+      bool in=true;
+      for(const float *plane : frustum.m_planes)
+      {
+        in=in && plane[0]*x[i]+plane[1]*y[i]+plane[2]*z[i]+plane[3]+r[i]>=0.0f;
+      }
+      bool listed=next<written && visible[next]==i;
+      if(listed)
+      {
+        ++next;
+      }
+      mismatches+= in!=listed;
+      if(i==nanSphere)
+      {
+        CHECK(!listed);
+      }
+    }
+    CHECK(mismatches==0);
+    CHECK(next==written);
+    CHECK(written>0 && written<count-begin);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the worst absolute error FastTrig.h states for each function of a tier
+//----------------------------------------------------------------------------------------------------------------------
+struct TrigBounds
+{
+  double m_sinCos;
+  double m_atan2;
+  double m_acosAsin;
+};
+
+template<rmath::TrigAccuracy A>
+void testTrigTier(const TrigBounds &_bounds)
+{
+  typedef rmath::FastTrig<A> Trig;
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> angle(-1.0e4f,1.0e4f);
+  std::uniform_real_distribution<float> unit(-1.0f,1.0f);
+  std::normal_distribution<float> normal;
+  // not a multiple of the SIMD width so the array functions finish on the scalar tail
+  const size_t count=20003;
+  std::vector<float> angles(count);
+  std::vector<float> units(count);
+  std::vector<float> y(count);
+  std::vector<float> x(count);
+  for(size_t i=0; i<count; ++i)
+  {
+    angles[i]=angle(rng);
+    units[i]=unit(rng);
+    y[i]=normal(rng);
+    x[i]=normal(rng);
+  }
+  // the ends of each domain, the axes and the origin for atan2
+  const float ends[]={0.0f,1.0f,-1.0f,1.0e4f,-1.0e4f,1.57079633f,-3.14159265f};
+  for(size_t i=0; i<sizeof(ends)/sizeof(ends[0]); ++i)
+  {
+    angles[i]=ends[i];
+    units[i]=std::max(-1.0f,std::min(1.0f,ends[i]));
+    y[i]=i%2 ? ends[i] : 0.0f;
+    x[i]=i%2 ? 0.0f : ends[i];
+  }
+
+  std::vector<float> out(count);
+  // worst error of the scalar and then the array version of a unary function
+  auto unaryError=[&](float (*_scalar)(float), void (*_array)(const float *, float *, size_t),
+                      const std::vector<float> &_in, double (*_reference)(double))
+  {
+    double worst=0.0;
+    _array(&_in[0],&out[0],count);
+    for(size_t i=0; i<count; ++i)
+    {
+      double exact=_reference(_in[i]);
+      worst=std::max(worst,std::fabs(_scalar(_in[i])-exact));
+      worst=std::max(worst,std::fabs(out[i]-exact));
+    }
+    return worst;
+  };
+  CHECK(unaryError(&Trig::template sin<float>,&Trig::sin,angles,[](double _v){ return std::sin(_v); })<_bounds.m_sinCos);
+  CHECK(unaryError(&Trig::template cos<float>,&Trig::cos,angles,[](double _v){ return std::cos(_v); })<_bounds.m_sinCos);
+  CHECK(unaryError(&Trig::template acos<float>,&Trig::acos,units,[](double _v){ return std::acos(_v); })<_bounds.m_acosAsin);
+  CHECK(unaryError(&Trig::template asin<float>,&Trig::asin,units,[](double _v){ return std::asin(_v); })<_bounds.m_acosAsin);
+  double atan2Error=0.0;
+  Trig::atan2(&y[0],&x[0],&out[0],count);
+  for(size_t i=0; i<count; ++i)
+  {
+    double exact=std::atan2(static_cast<double>(y[i]),static_cast<double>(x[i]));
+    atan2Error=std::max(atan2Error,std::fabs(Trig::atan2(y[i],x[i])-exact));
+    atan2Error=std::max(atan2Error,std::fabs(out[i]-exact));
+  }
+  CHECK(atan2Error<_bounds.m_atan2);
+
+  // a NaN comes back as NaN, in the register lanes and in the tail
+  const float nan=std::numeric_limits<float>::quiet_NaN();
+  const size_t nanCount=19;
+  std::vector<float> nans(nanCount,nan);
+  std::vector<float> ones(nanCount,1.0f);
+  std::vector<float> result(nanCount);
+  bool allNan=std::isnan(Trig::sin(nan)) && std::isnan(Trig::cos(nan)) && std::isnan(Trig::acos(nan)) &&
+              std::isnan(Trig::asin(nan)) && std::isnan(Trig::atan2(nan,1.0f)) && std::isnan(Trig::atan2(1.0f,nan)) &&
+              std::isnan(Trig::atan2(nan,nan));
+  auto arrayNan=[&]()
+  {
+    for(float v : result)
+    {
+      allNan=allNan && std::isnan(v);
+    }
+  };
+  Trig::sin(&nans[0],&result[0],nanCount);
+  arrayNan();
+  Trig::cos(&nans[0],&result[0],nanCount);
+  arrayNan();
+  Trig::acos(&nans[0],&result[0],nanCount);
+  arrayNan();
+  Trig::asin(&nans[0],&result[0],nanCount);
+  arrayNan();
+  Trig::atan2(&nans[0],&ones[0],&result[0],nanCount);
+  arrayNan();
+  Trig::atan2(&ones[0],&nans[0],&result[0],nanCount);
+  arrayNan();
+  CHECK(allNan);
+}
+
+void testTrig()
+{
+  // FULL is float libm, a few float ulps of the largest result (pi)
+  testTrigTier<rmath::TrigAccuracy::FULL>({1.0e-6,1.0e-6,1.0e-6});
+  testTrigTier<rmath::TrigAccuracy::MEDIUM>({1.0e-6,2.0e-6,6.0e-6});
+  testTrigTier<rmath::TrigAccuracy::LOW>({7.0e-5,7.0e-4,4.0e-4});
+}
+
+} // end anon namespace
+
+int main()
+{
+  testBatch();
+  testTransforms();
+  testJobs();
+  testDrawQueue();
+  testAnimation();
+  testCull();
+  testTrig();
+  std::cout<<"rottest : "<<s_checks-s_failures<<" of "<<s_checks<<" checks passed ("<<rmath::rotationBatchISA()<<")\n";
+  return s_failures==0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
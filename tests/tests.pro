@@ -0,0 +1,25 @@
+# unit tests for the rotationmath library and the GL free parts of the demo,
+# run with make check (or run rottest directly), exits non zero on a failure
+TARGET=rottest
+TEMPLATE=app
+CONFIG+=console c++11 testcase
+CONFIG-=qt app_bundle
+OBJECTS_DIR=obj
+# put the exe in the project root next to the demo
+DESTDIR=$$PWD/..
+SOURCES+= $$PWD/src/*.cpp
+INCLUDEPATH +=$$PWD/../rotationmath/include
+# DrawQueue is part of the demo but touches no GL, it is built straight from the demo sources
+SOURCES+= $$PWD/../src/DrawQueue.cpp
+INCLUDEPATH +=$$PWD/../include
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+# the batch / scalar bit equality test relies on the same no fused multiply add rule as the library
+QMAKE_CXXFLAGS+= -ffp-contract=off
+linux-*:QMAKE_CXXFLAGS +=  -march=native
+win32:DEFINES+=_USE_MATH_DEFINES
+# the JobSystem checks start threads
+unix:LIBS+= -pthread
+unix:LIBS+= -L$$PWD/../lib -lRotationMath
+unix:PRE_TARGETDEPS+=$$PWD/../lib/libRotationMath.a
+win32:LIBS+= -L$$PWD/../lib -lRotationMath
+win32:PRE_TARGETDEPS+=$$PWD/../lib/RotationMath.lib